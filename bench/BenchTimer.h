@@ -0,0 +1,36 @@
+#ifndef __BENCHTIMER_H
+#define __BENCHTIMER_H
+#include <chrono>
+
+/**
+ * @file BenchTimer.h
+ * @brief Wall-clock timing for the host benchmarks.
+ *
+ * micros() in a host build is the shim's virtual clock, which only moves
+ * on delay() and the mock's latency model, so CPU work is timed with
+ * std::chrono instead. benchBest() runs a workload several times and keeps
+ * the fastest run, which filters out scheduler noise on a desktop.
+ */
+
+static inline double benchSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Fastest of runs calls of fn(arg), in seconds
+ */
+static inline double benchBest(void (*fn)(void *), void *arg, int runs = 5)
+{
+    double best = 1e30;
+    for (int i = 0; i < runs; i++)
+    {
+        double start = benchSeconds();
+        fn(arg);
+        double elapsed = benchSeconds() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+#endif // __BENCHTIMER_H
@@ -0,0 +1,63 @@
+/**
+ * @file bench_fill.cpp
+ * @brief Cost per call of fillScreen() and of a 100 x 100 fill.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++17 -O2 -Isrc bench/bench_fill.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o bench_fill
+ *   ./bench_fill
+ *
+ * fillScreen() cycles WHITE / BLACK / RED. The 100 x 100 box sits at the
+ * screen centre and alternates BLACK / RED, once through fillRect() and once
+ * through drawRectangle(..., DRAW_FULL). Figures are the best of five runs,
+ * in microseconds per call.
+ */
+#include "EPDDisplay.h"
+#include "BenchTimer.h"
+
+#define SCREENS 20000
+#define BOXES 200000
+
+static void fillScreens(void *arg)
+{
+    EPDDisplay *display = (EPDDisplay *)arg;
+    for (int i = 0; i < SCREENS; i++)
+    {
+        display->fillScreen((EPDDisplay::COLOR)(EPDDisplay::WHITE + i % 3));
+    }
+}
+
+static void fillRects(void *arg)
+{
+    EPDDisplay *display = (EPDDisplay *)arg;
+    for (int i = 0; i < BOXES; i++)
+    {
+        display->fillRect(390, 214, 100, 100, (EPDDisplay::COLOR)(EPDDisplay::BLACK + i % 2));
+    }
+}
+
+static void filledRectangles(void *arg)
+{
+    EPDDisplay *display = (EPDDisplay *)arg;
+    for (int i = 0; i < BOXES; i++)
+    {
+        display->drawRectangle(390, 214, 490, 314, (EPDDisplay::COLOR)(EPDDisplay::BLACK + i % 2),
+                               1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    }
+}
+
+int main()
+{
+    EPDMockTransport mock;
+    EPDDisplay display(&mock);
+    if (!display.initialize())
+    {
+        printf("initialize() failed\n");
+        return 1;
+    }
+
+    printf("fillScreen()                       %8.2f us\n", benchBest(fillScreens, &display) / SCREENS * 1e6);
+    printf("100x100 fillRect()                 %8.2f us\n", benchBest(fillRects, &display) / BOXES * 1e6);
+    printf("100x100 drawRectangle(DRAW_FULL)   %8.2f us\n", benchBest(filledRectangles, &display) / BOXES * 1e6);
+    return 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file bench_gpio_transitions.cpp
+ * @brief GPIO writes and level transitions per plane and per frame with the
+ *        bit-banged transport, counted by the host shim's pin layer.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++17 -O2 -Isrc bench/bench_gpio_transitions.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o bench_gpio_transitions
+ *   ./bench_gpio_transitions
+ *
+ * "per byte" sends a plane with one writeData() per byte, each in its own
+ * CS-low window with DC set again, as every byte was sent before data
+ * bursts existed. "burst" sends the same plane with beginData() /
+ * writeDataSpan() / endData(). The frame figures are display() and clear()
+ * of a scene with text and a filled circle.
+ */
+#include "EPDDisplay.h"
+
+static const uint32_t PLANE_BYTES = 110UL * 528;
+
+static void report(const char *name, uint32_t bytes)
+{
+    uint32_t writes = EPDHost::gpioWriteCount();
+    uint32_t transitions = EPDHost::gpioTransitionCount();
+    printf("%-26s %9u writes %9u transitions", name, writes, transitions);
+    if (bytes > 0)
+    {
+        printf("  (%.2f / %.2f per byte)", (double)writes / bytes, (double)transitions / bytes);
+    }
+    printf("\n");
+}
+
+int main()
+{
+    // Mostly white plane with some ink, like a page of text
+    static uint8_t plane[PLANE_BYTES];
+    for (uint32_t i = 0; i < PLANE_BYTES; i++)
+    {
+        plane[i] = (i % 7 == 0) ? (uint8_t)(0x81 ^ (i >> 3)) : 0xFF;
+    }
+
+    EPDBitBangTransport transport(17, 5, 18, 23);
+    transport.begin();
+
+    EPDHost::resetGpioCounters();
+    for (uint32_t i = 0; i < PLANE_BYTES; i++)
+    {
+        transport.writeData(plane[i]);
+    }
+    report("plane, per byte", PLANE_BYTES);
+
+    EPDHost::resetGpioCounters();
+    transport.beginData();
+    transport.writeDataSpan(plane, PLANE_BYTES);
+    transport.endData();
+    report("plane, burst", PLANE_BYTES);
+
+    EPDDisplay display(4, 16, 17, 5, 18, 23);
+    if (!display.initialize())
+    {
+        printf("initialize() failed\n");
+        return 1;
+    }
+    display.fillScreen(EPDDisplay::WHITE);
+    display.drawString(10, 10, "Hello world", &EPDDisplay::Font24, EPDDisplay::BLACK, EPDDisplay::NULL_COLOR);
+    display.drawCircle(300, 300, 100, EPDDisplay::RED, 1, EPDDisplay::DRAW_FULL);
+
+    EPDHost::resetGpioCounters();
+    display.display();
+    report("display()", 0);
+
+    EPDHost::resetGpioCounters();
+    display.clear();
+    report("clear()", 0);
+    return 0;
+}
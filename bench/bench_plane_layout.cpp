@@ -0,0 +1,125 @@
+/**
+ * @file bench_plane_layout.cpp
+ * @brief Drawing and upload costs that depend on how the black and red
+ *        planes are stored.
+ *
+ * Build and run from the repository root, once per layout:
+ *   g++ -std=gnu++17 -O2 -Isrc bench/bench_plane_layout.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o bench_separate
+ *   g++ -std=gnu++17 -O2 -Isrc -DEPD_INTERLEAVED_PLANES=1 bench/bench_plane_layout.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o bench_interleaved
+ *   ./bench_separate && ./bench_interleaved
+ *
+ * Covers opaque and transparent text, a circle outline, a full-width line,
+ * a filled circle, drawPixel() at random positions and the CPU time of
+ * display() with both planes changed (the interleaved layout de-interleaves
+ * while uploading). Figures are the best of five runs.
+ */
+#include "EPDDisplay.h"
+#include "BenchTimer.h"
+
+#define TEXT_LINES 2000
+#define OUTLINES 2000
+#define FILLS 300
+#define PIXELS 2000000
+#define FRAMES 40
+
+static const char *TEXT = "The quick brown fox jumps over the lazy dog 0123456789";
+
+static void opaqueText(void *arg)
+{
+    EPDDisplay *display = (EPDDisplay *)arg;
+    for (int i = 0; i < TEXT_LINES; i++)
+    {
+        display->drawString(0, (i * 24) % 500, TEXT, &EPDDisplay::Font24, EPDDisplay::BLACK, EPDDisplay::WHITE);
+    }
+}
+
+static void transparentText(void *arg)
+{
+    EPDDisplay *display = (EPDDisplay *)arg;
+    for (int i = 0; i < TEXT_LINES; i++)
+    {
+        display->drawString(0, (i * 16) % 510, TEXT, &EPDDisplay::Font16, EPDDisplay::RED, EPDDisplay::NULL_COLOR);
+    }
+}
+
+static void circleOutlines(void *arg)
+{
+    EPDDisplay *display = (EPDDisplay *)arg;
+    for (int i = 0; i < OUTLINES; i++)
+    {
+        display->drawCircle(440, 264, 250, (EPDDisplay::COLOR)(EPDDisplay::BLACK + i % 2), 1, EPDDisplay::DRAW_EMPTY);
+    }
+}
+
+static void lines(void *arg)
+{
+    EPDDisplay *display = (EPDDisplay *)arg;
+    for (int i = 0; i < OUTLINES; i++)
+    {
+        display->drawLine(0, i % 528, 879, 527 - i % 528, (EPDDisplay::COLOR)(EPDDisplay::BLACK + i % 2),
+                          1, EPDDisplay::LINE_SOLID);
+    }
+}
+
+static void filledCircles(void *arg)
+{
+    EPDDisplay *display = (EPDDisplay *)arg;
+    for (int i = 0; i < FILLS; i++)
+    {
+        display->drawCircle(440, 264, 200, (EPDDisplay::COLOR)(EPDDisplay::BLACK + i % 2), 1, EPDDisplay::DRAW_FULL);
+    }
+}
+
+static void randomPixels(void *arg)
+{
+    EPDDisplay *display = (EPDDisplay *)arg;
+    uint32_t seed = 1;
+    for (int i = 0; i < PIXELS; i++)
+    {
+        seed = seed * 1664525UL + 1013904223UL;
+        display->drawPixel((seed >> 8) % 880, (seed >> 20) % 528, (EPDDisplay::COLOR)(EPDDisplay::BLACK + (i & 1)));
+    }
+}
+
+// Only display() is timed; the drawing between frames is not
+static double displayBest(EPDMockTransport *mock, EPDDisplay *display)
+{
+    double best = 1e30;
+    for (int i = 0; i < FRAMES; i++)
+    {
+        display->fillScreen(EPDDisplay::WHITE);
+        display->drawCircle(440, 264, 200 + i % 2, EPDDisplay::RED, 1, EPDDisplay::DRAW_FULL);
+        display->drawString(0, 0, "abc", &EPDDisplay::Font24, EPDDisplay::BLACK, EPDDisplay::WHITE);
+        mock->clearLog();
+        double start = benchSeconds();
+        display->display();
+        double elapsed = benchSeconds() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+int main()
+{
+    EPDMockTransport mock;
+    EPDDisplay display(&mock);
+    if (!display.initialize())
+    {
+        printf("initialize() failed\n");
+        return 1;
+    }
+    display.fillScreen(EPDDisplay::WHITE);
+
+    double chars = (double)TEXT_LINES * strlen(TEXT);
+    printf("layout: %s\n", EPD_INTERLEAVED_PLANES ? "interleaved" : "separate");
+    printf("Font24 opaque text        %8.1f ns/char\n", benchBest(opaqueText, &display) / chars * 1e9);
+    printf("Font16 transparent text   %8.1f ns/char\n", benchBest(transparentText, &display) / chars * 1e9);
+    printf("circle outline r=250      %8.2f us\n", benchBest(circleOutlines, &display) / OUTLINES * 1e6);
+    printf("880-px line               %8.2f us\n", benchBest(lines, &display) / OUTLINES * 1e6);
+    printf("filled circle r=200       %8.2f us\n", benchBest(filledCircles, &display) / FILLS * 1e6);
+    printf("drawPixel, random         %8.2f ns\n", benchBest(randomPixels, &display) / PIXELS * 1e9);
+    printf("display() CPU time        %8.0f us\n", displayBest(&mock, &display) * 1e6);
+    return 0;
+}
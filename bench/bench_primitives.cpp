@@ -0,0 +1,65 @@
+/**
+ * @file bench_primitives.cpp
+ * @brief Throughput of a large filled circle and of opaque and transparent
+ *        text.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++17 -O2 -Isrc bench/bench_primitives.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o bench_primitives
+ *   ./bench_primitives
+ *
+ * The circle is r = 200 at the screen centre, alternating BLACK / RED. The
+ * text is a 54-character line, Font24 BLACK on WHITE and Font16 RED on
+ * NULL_COLOR, stepped down the screen. Figures are the best of five runs.
+ */
+#include "EPDDisplay.h"
+#include "BenchTimer.h"
+
+#define CIRCLES 200
+#define LINES 2000
+
+static const char *TEXT = "The quick brown fox jumps over the lazy dog 0123456789";
+
+static void filledCircles(void *arg)
+{
+    EPDDisplay *display = (EPDDisplay *)arg;
+    for (int i = 0; i < CIRCLES; i++)
+    {
+        display->drawCircle(440, 264, 200, (EPDDisplay::COLOR)(EPDDisplay::BLACK + i % 2), 1, EPDDisplay::DRAW_FULL);
+    }
+}
+
+static void opaqueText(void *arg)
+{
+    EPDDisplay *display = (EPDDisplay *)arg;
+    for (int i = 0; i < LINES; i++)
+    {
+        display->drawString(0, (i * 24) % 500, TEXT, &EPDDisplay::Font24, EPDDisplay::BLACK, EPDDisplay::WHITE);
+    }
+}
+
+static void transparentText(void *arg)
+{
+    EPDDisplay *display = (EPDDisplay *)arg;
+    for (int i = 0; i < LINES; i++)
+    {
+        display->drawString(0, (i * 24) % 500, TEXT, &EPDDisplay::Font16, EPDDisplay::RED, EPDDisplay::NULL_COLOR);
+    }
+}
+
+int main()
+{
+    EPDMockTransport mock;
+    EPDDisplay display(&mock);
+    if (!display.initialize())
+    {
+        printf("initialize() failed\n");
+        return 1;
+    }
+
+    double chars = (double)LINES * strlen(TEXT);
+    printf("filled circle r=200       %8.1f circles/s\n", CIRCLES / benchBest(filledCircles, &display));
+    printf("text Font24 opaque        %8.0f kchar/s\n", chars / benchBest(opaqueText, &display) / 1e3);
+    printf("text Font16 transparent   %8.0f kchar/s\n", chars / benchBest(transparentText, &display) / 1e3);
+    return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file bench_rotation.cpp
+ * @brief drawPixel() throughput for each of the 16 rotate / mirror
+ *        combinations.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++17 -O2 -Isrc bench/bench_rotation.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o bench_rotation
+ *   ./bench_rotation
+ *
+ * Each run sets every pixel of the logical screen once through the public
+ * drawPixel(), cycling WHITE / BLACK / RED. The figure is the best of five
+ * runs, in millions of pixels per second.
+ */
+#include "EPDDisplay.h"
+#include "BenchTimer.h"
+
+struct Screen
+{
+    EPDDisplay *display;
+    uint16_t width;
+    uint16_t height;
+};
+
+static void fillByPixels(void *arg)
+{
+    Screen *screen = (Screen *)arg;
+    for (uint16_t y = 0; y < screen->height; y++)
+    {
+        for (uint16_t x = 0; x < screen->width; x++)
+        {
+            screen->display->drawPixel(x, y, (EPDDisplay::COLOR)(1 + (x + y) % 3));
+        }
+    }
+}
+
+int main()
+{
+    static const uint8_t rotations[4] = {EPDDisplay::ROTATE_0, EPDDisplay::ROTATE_90,
+                                         EPDDisplay::ROTATE_180, EPDDisplay::ROTATE_270};
+    static const char *mirrors[4] = {"none", "horizontal", "vertical", "origin"};
+
+    EPDMockTransport mock;
+    EPDDisplay display(&mock);
+    if (!display.initialize())
+    {
+        printf("initialize() failed\n");
+        return 1;
+    }
+
+    for (int r = 0; r < 4; r++)
+    {
+        for (int m = 0; m < 4; m++)
+        {
+            display.setRotation(rotations[r]);
+            display.setMirror(m);
+            Screen screen = {&display, (uint16_t)(r % 2 ? 528 : 880), (uint16_t)(r % 2 ? 880 : 528)};
+            double seconds = benchBest(fillByPixels, &screen);
+            printf("rotate %3d, mirror %-10s %7.1f Mpx/s\n", r * 90, mirrors[m],
+                   (double)screen.width * screen.height / seconds / 1e6);
+        }
+    }
+    return 0;
+}
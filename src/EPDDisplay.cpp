@@ -5,52 +5,143 @@
  * Stores pin numbers and sets all member variables to their initial/default
  * values. No GPIO configuration or SPI communication happens here — that is
  * deferred to initialize() so the object can be created at global scope
- * before the Arduino runtime is ready.
+ * before the Arduino runtime is ready. The transport object is created here
+ * (it only stores pins) and started by initialize().
  */
 #include "EPDDisplay.h"
 
-// Constructor with pin parameters
+// Constructor with pin parameters: the SPI pins and a transport of its own
+// on top of what the transport constructor below sets up
 EPDDisplay::EPDDisplay(
     int busy_pin,
     int rst_pin,
     int dc_pin,
     int cs_pin,
     int clk_pin,
-    int din_pin) : blackBuffer(NULL),
-                   redBuffer(NULL),
-                   isInitialized(false),
-                   isSleep(false),
-                   width(EPD_7IN5B_HD_WIDTH),
-                   height(EPD_7IN5B_HD_HEIGHT),
-                   // widthByte: bytes per row = ceil(width / 8).
-                   // For 880 px: 880 / 8 = 110 bytes exactly.
-                   widthByte((EPD_7IN5B_HD_WIDTH % 8 == 0) ? (EPD_7IN5B_HD_WIDTH / 8) : (EPD_7IN5B_HD_WIDTH / 8 + 1)),
-                   heightByte(EPD_7IN5B_HD_HEIGHT),
-                   widthMemory(EPD_7IN5B_HD_WIDTH),   // 880
-                   heightMemory(EPD_7IN5B_HD_HEIGHT), // 528
-                   rotate(EPDDisplay::ROTATE_0),
-                   mirror(EPDDisplay::MIRROR_NONE),
-                   m_BUSY_pin(busy_pin),
-                   m_RST_pin(rst_pin),
-                   m_DC_pin(dc_pin),
-                   m_CS_pin(cs_pin),
-                   m_CLK_pin(clk_pin),
-                   m_DIN_pin(din_pin)
+    int din_pin,
+    TRANSPORT transport) : EPDDisplay(busy_pin, rst_pin, (EPDTransport *)NULL)
+{
+    m_DC_pin = dc_pin;
+    m_CS_pin = cs_pin;
+    m_CLK_pin = clk_pin;
+    m_DIN_pin = din_pin;
+    ownsTransport = true;
+    if (transport == EPDDisplay::TRANSPORT_VSPI_DMA || transport == EPDDisplay::TRANSPORT_HSPI_DMA)
+    {
+        this->transport = new EPDHwSpiTransport(dc_pin, cs_pin, clk_pin, din_pin,
+                                                transport == EPDDisplay::TRANSPORT_HSPI_DMA ? EPDHwSpiTransport::SPI_BUS_HSPI : EPDHwSpiTransport::SPI_BUS_VSPI);
+    }
+    else
+    {
+        this->transport = new EPDBitBangTransport(dc_pin, cs_pin, clk_pin, din_pin);
+    }
+}
+
+// Constructor with a caller-provided transport. The only one that
+// initializes every member: the other constructors delegate to it.
+EPDDisplay::EPDDisplay(
+    int busy_pin,
+    int rst_pin,
+    EPDTransport *transport) : blackBuffer(NULL),
+                               redBuffer(NULL),
+                               frontBlack(NULL),
+                               frontRed(NULL),
+                               allocPolicy(EPDDisplay::ALLOC_AUTO),
+                               ownsBuffers(true),
+                               rowHash(NULL),
+                               isInitialized(false),
+                               isSleep(false),
+                               width(EPD_7IN5B_HD_WIDTH),
+                               height(EPD_7IN5B_HD_HEIGHT),
+                               // widthByte: bytes per row = ceil(width / 8).
+                               // For 880 px: 880 / 8 = 110 bytes exactly.
+                               widthByte((EPD_7IN5B_HD_WIDTH % 8 == 0) ? (EPD_7IN5B_HD_WIDTH / 8) : (EPD_7IN5B_HD_WIDTH / 8 + 1)),
+                               heightByte(EPD_7IN5B_HD_HEIGHT),
+                               widthMemory(EPD_7IN5B_HD_WIDTH),   // 880
+                               heightMemory(EPD_7IN5B_HD_HEIGHT), // 528
+                               bufferRowOffset(0),
+                               bufferRows(EPD_7IN5B_HD_HEIGHT),
+                               bandHeight(0),
+                               rotate(EPDDisplay::ROTATE_0),
+                               mirror(EPDDisplay::MIRROR_NONE),
+                               m_BUSY_pin(busy_pin),
+                               m_RST_pin(rst_pin),
+                               m_DC_pin(-1),
+                               m_CS_pin(-1),
+                               m_CLK_pin(-1),
+                               m_DIN_pin(-1),
+                               ramSynced(false),
+                               commitPending(false),
+                               transport(transport),
+                               ownsTransport(false),
+                               refreshActive(false),
+                               refreshBusyEdge(false),
+                               refreshStart(0),
+                               refreshCallback(NULL),
+                               refreshCallbackArg(NULL),
+                               refreshNotifyTask(NULL),
+                               refreshMode(EPDDisplay::REFRESH_FULL_TRICOLOR),
+                               lastRefreshMode(EPDDisplay::REFRESH_FULL_TRICOLOR),
+                               loadedWaveform(NULL),
+                               activeUpdateSequence(0xC7),
+                               frameStartUs(0),
+                               frameTriggerUs(0),
+                               lastFrameEndUs(0),
+                               frameOpen(false),
+                               frameTimingCallback(NULL),
+                               frameTimingCallbackArg(NULL),
+                               startupTimingCallback(NULL),
+                               startupTimingCallbackArg(NULL),
+                               initGuardMs(EPD_INIT_GUARD_MS),
+                               lightSleep(false),
+                               frameStore(NULL),
+                               fingerprint(NULL),
+                               resumeFrame(false)
+{
+    waveforms[EPDDisplay::REFRESH_FULL_TRICOLOR] = &WAVEFORM_FULL_TRICOLOR;
+    waveforms[EPDDisplay::REFRESH_FAST_BW] = &WAVEFORM_FAST_BW;
+    waveforms[EPDDisplay::REFRESH_PARTIAL_BW] = &WAVEFORM_PARTIAL_BW;
+    emptyRect(&dirty);
+    emptyRect(&frontDirty);
+    memset(&uploadStats, 0, sizeof(uploadStats));
+    memset(&frameTiming, 0, sizeof(frameTiming));
+    memset(&lastFrameTiming, 0, sizeof(lastFrameTiming));
+    memset(&startupTiming, 0, sizeof(startupTiming));
+    updateTransform();
+}
+
+// Constructor with a transport that also drives BUSY / RST
+EPDDisplay::EPDDisplay(EPDTransport *transport) : EPDDisplay(-1, -1, transport)
 {
 }
 
 // Destructor
 EPDDisplay::~EPDDisplay()
 {
-    if (blackBuffer != NULL)
+    if (refreshActive)
+    {
+        transport->detachBusyInterrupt();
+        refreshActive = false;
+    }
+
+    freeFramebuffers();
+    freeBackBuffers();
+
+    if (rowHash != NULL)
+    {
+        free(rowHash);
+        rowHash = NULL;
+    }
+
+    if (fingerprint != NULL)
     {
-        free(blackBuffer);
-        blackBuffer = NULL;
+        free(fingerprint);
+        fingerprint = NULL;
     }
 
-    if (redBuffer != NULL)
+    if (ownsTransport && transport != NULL)
     {
-        free(redBuffer);
-        redBuffer = NULL;
+        delete transport;
+        transport = NULL;
     }
 }
@@ -1,17 +1,51 @@
 #ifndef __EPDDISPLAY_H
 #define __EPDDISPLAY_H
+#ifdef ARDUINO
 #include <Arduino.h>
+#else
+#include "EPDHostShim.h"
+#endif
 
 // Definitions for the EPD 7.5" B HD display
 #define EPD_7IN5B_HD_WIDTH 880
 #define EPD_7IN5B_HD_HEIGHT 528
 
+// Watchdog for any wait on the BUSY signal (a full refresh takes ~15–20 s)
+#define EPD_BUSY_TIMEOUT_MS 30000
+
+// Settle time after BUSY releases at the end of a refresh
+#define EPD_BUSY_SETTLE_MS 200
+
+// Default guard time after BUSY releases during reset and init (see setInitGuardTime())
+#define EPD_INIT_GUARD_MS 1
+
+// Rows per fingerprint band persisted across MCU deep sleep (see setFrameStore())
+#define EPD_FINGERPRINT_BAND_ROWS 8
+#define EPD_FINGERPRINT_BANDS ((EPD_7IN5B_HD_HEIGHT + EPD_FINGERPRINT_BAND_ROWS - 1) / EPD_FINGERPRINT_BAND_ROWS)
+
+// Framebuffer layout. 0: two separate planes. 1: one buffer holding the
+// black and red byte of each 8-pixel group side by side, so a pixel write
+// touches one cache line instead of two; uploads de-interleave on the fly.
+#ifndef EPD_INTERLEAVED_PLANES
+#define EPD_INTERLEAVED_PLANES 0
+#endif
+// Distance between two consecutive bytes of one plane
+#if EPD_INTERLEAVED_PLANES
+#define EPD_PLANE_STRIDE 2
+#else
+#define EPD_PLANE_STRIDE 1
+#endif
+
 #ifdef DEBUG
 #define Debug(__info) Serial.print(__info)
 #else
 #define Debug(__info)
 #endif
 
+#include "EPDTransport.h"
+#include "EPDFrameStore.h"
+#include "EPDPlaneOps.h"
+
 /**
  * @brief Class to manage display on a 7.5" B HD e-Paper screen with black, white and red colors
  * This class encapsulates the functionalities of Paint and EPD_7IN5B_HD
@@ -34,6 +68,81 @@ public:
         uint16_t height;
     } sFONT;
 
+    /**
+     * @brief Refresh completion callback
+     * @param display Display whose refresh finished
+     * @param arg User argument given to setRefreshCallback()
+     */
+    typedef void (*RefreshCallback)(EPDDisplay *display, void *arg);
+
+    /**
+     * @brief Draw callback for renderBanded()
+     * Draws the whole screen with the usual drawing functions; it is called
+     * once per band and only the pixels of the current band are kept.
+     * @param display Display to draw on
+     * @param arg User argument given to renderBanded()
+     */
+    typedef void (*DrawCallback)(EPDDisplay *display, void *arg);
+
+    /**
+     * @brief Framebuffer upload counters (see getUploadStats())
+     * Byte counts cover plane data only (0x24 / 0x26 payload); planes filled
+     * with Auto Write RAM count as skipped bytes.
+     */
+    typedef struct
+    {
+        uint32_t bytesSent;     // Plane bytes sent to controller RAM
+        uint32_t bytesSkipped;  // Dirty-window bytes not sent because the row was unchanged
+        uint32_t planesSkipped; // 0x24 / 0x26 uploads skipped entirely
+        uint32_t autoWrites;    // Uniform planes filled with Auto Write RAM (0x46 / 0x47) instead
+        uint32_t refreshesSkipped; // display() calls after a resume that found the panel up to date
+    } UploadStats;
+
+    /**
+     * @brief Where the time of one frame went (see getFrameTiming())
+     * Measured with the transport clock, so on a host with a latency model
+     * (EPDMockTransport::setLatencyModel()) these are modelled device times.
+     */
+    typedef struct
+    {
+        uint32_t renderUs; // Since the previous frame completed, plus renderBanded() draw calls
+        uint32_t uploadUs; // Commands and data sent to the controller
+        uint32_t busyUs;   // Waiting on BUSY: refresh, LUT load, auto write
+        uint32_t settleUs; // Fixed delays after BUSY release / refresh trigger
+        uint32_t totalUs;  // uploadUs + busyUs + settleUs: display() call to refresh done
+        uint32_t sleptUs;  // Part of busyUs the CPU spent in light sleep (see setLightSleep())
+    } FrameTiming;
+
+    /**
+     * @brief Frame timing callback
+     * @param display Display whose frame completed
+     * @param timing Breakdown of that frame
+     * @param arg User argument given to setFrameTimingCallback()
+     */
+    typedef void (*FrameTimingCallback)(EPDDisplay *display, const FrameTiming *timing, void *arg);
+
+    /**
+     * @brief Where the time of the last controller start went (see getStartupTiming())
+     * A start is the hardware reset plus the init command table, run by
+     * initialize() and wakeUp(). Same clock as FrameTiming.
+     */
+    typedef struct
+    {
+        uint32_t resetUs;  // RST pulse and controller boot, up to BUSY release
+        uint32_t uploadUs; // Init commands and data sent to the controller
+        uint32_t busyUs;   // Waiting on BUSY in the table: software reset, auto write, LUT load
+        uint32_t settleUs; // Guard time after each BUSY release in the table
+        uint32_t totalUs;  // resetUs + uploadUs + busyUs + settleUs
+    } StartupTiming;
+
+    /**
+     * @brief Startup timing callback
+     * @param display Display that finished starting
+     * @param timing Breakdown of that start
+     * @param arg User argument given to setStartupTimingCallback()
+     */
+    typedef void (*StartupTimingCallback)(EPDDisplay *display, const StartupTiming *timing, void *arg);
+
     /**************
      * Variables
      **************/
@@ -94,6 +203,77 @@ public:
         DRAW_FULL = 1
     } DRAW_FILL;
 
+    /**
+     * @brief SPI transport selection
+     * Available transports: TRANSPORT_BITBANG (any GPIOs), TRANSPORT_VSPI_DMA, TRANSPORT_HSPI_DMA (ESP32 SPI peripheral)
+     */
+    typedef enum
+    {
+        TRANSPORT_BITBANG = 0,
+        TRANSPORT_VSPI_DMA = 1,
+        TRANSPORT_HSPI_DMA = 2
+    } TRANSPORT;
+
+    /**
+     * @brief Framebuffer allocation policy
+     * Available policies: ALLOC_AUTO (placement picked for the transport), ALLOC_INTERNAL_DMA,
+     * ALLOC_PSRAM, ALLOC_CALLER (buffers given with setFramebuffers())
+     */
+    typedef enum
+    {
+        ALLOC_AUTO = 0,
+        ALLOC_INTERNAL_DMA = 1,
+        ALLOC_PSRAM = 2,
+        ALLOC_CALLER = 3
+    } ALLOC_POLICY;
+
+    /**
+     * @brief Memory a framebuffer plane lives in
+     * Available placements: MEMORY_NONE (not allocated), MEMORY_INTERNAL_DMA,
+     * MEMORY_INTERNAL (internal, not DMA-capable), MEMORY_PSRAM
+     */
+    typedef enum
+    {
+        MEMORY_NONE = 0,
+        MEMORY_INTERNAL_DMA = 1,
+        MEMORY_INTERNAL = 2,
+        MEMORY_PSRAM = 3
+    } MEMORY_PLACEMENT;
+
+    /**
+     * @brief Refresh mode selection
+     * Available modes: REFRESH_FULL_TRICOLOR (default, ~15–20 s), REFRESH_FAST_BW,
+     * REFRESH_PARTIAL_BW (black/white only, a few seconds)
+     */
+    typedef enum
+    {
+        REFRESH_FULL_TRICOLOR = 0,
+        REFRESH_FAST_BW = 1,
+        REFRESH_PARTIAL_BW = 2
+    } REFRESH_MODE;
+
+    /**
+     * @brief Waveform used by a refresh mode (see EPDDisplay_Waveforms.cpp)
+     * A custom LUT is written with command 0x32; its loadSequence must then not
+     * set the "load LUT" bit (0x10), which would replace it with the OTP LUT.
+     */
+    typedef struct
+    {
+        const uint8_t *lut;       // Custom LUT bytes for command 0x32, or NULL to use the OTP LUT
+        uint16_t lutLength;       // Number of LUT bytes
+        bool overrideTemperature; // Write `temperature` to 0x1A instead of using the internal sensor
+        int8_t temperature;       // Forced temperature in °C (selects the OTP waveform)
+        uint8_t loadSequence;     // 0x22 value that loads the waveform, 0 = none
+        uint8_t updateSequence;   // 0x22 value for the refresh itself
+    } Waveform;
+
+    /**
+     * @brief Built-in waveforms for each refresh mode
+     */
+    static const Waveform WAVEFORM_FULL_TRICOLOR;
+    static const Waveform WAVEFORM_FAST_BW;
+    static const Waveform WAVEFORM_PARTIAL_BW;
+
     /**
      * @brief Available font sizes
      * Font8, Font12, Font16, Font20, Font24
@@ -112,13 +292,32 @@ public:
      * @param cs_pin CS signal pin
      * @param clk_pin CLK signal pin (SCK)
      * @param din_pin DIN signal pin (MOSI)
+     * @param transport SPI backend (EPDDisplay::TRANSPORT_BITBANG, EPDDisplay::TRANSPORT_VSPI_DMA, EPDDisplay::TRANSPORT_HSPI_DMA).
+     *        If the hardware SPI backend cannot be started, initialize() falls back to bit-banging.
+     */
+    EPDDisplay(int busy_pin, int rst_pin, int dc_pin, int cs_pin, int clk_pin, int din_pin, TRANSPORT transport = TRANSPORT_BITBANG);
+
+    /**
+     * @brief Constructor with a caller-provided transport (e.g. EPDMockTransport)
+     * @param busy_pin BUSY signal pin
+     * @param rst_pin RST signal pin
+     * @param transport Transport used for all command/data bytes. Not owned: must outlive the display.
      */
-    EPDDisplay(int busy_pin, int rst_pin, int dc_pin, int cs_pin, int clk_pin, int din_pin);
+    EPDDisplay(int busy_pin, int rst_pin, EPDTransport *transport);
+
+    /**
+     * @brief Constructor with a transport that also handles BUSY and RST
+     * For transports that reach the panel without Arduino GPIO (or whose
+     * pins were set with EPDTransport::setControlPins()).
+     * @param transport Transport used for all panel I/O. Not owned: must outlive the display.
+     */
+    EPDDisplay(EPDTransport *transport);
 
     /**
      * @brief Destructor - frees allocated memory
+     * Virtual: EPDDisplayT and other subclasses may be deleted through an EPDDisplay *.
      */
-    ~EPDDisplay();
+    virtual ~EPDDisplay();
 
     /** ***************************************
     HARDWARE FUNCTIONS
@@ -129,8 +328,62 @@ public:
      */
     bool initialize();
 
+    /**
+     * @brief Choose where initialize() / initializeBanded() / enableDoubleBuffer() allocate the planes
+     * Must be called before initialize(). ALLOC_AUTO puts the planes in internal
+     * DMA-capable RAM for DMA transports (zero-copy uploads) and in PSRAM, when
+     * present, for the bit-banged ones (keeping internal heap free), falling
+     * back to the other memory. ALLOC_INTERNAL_DMA and ALLOC_PSRAM fail
+     * instead of falling back.
+     * @param policy Allocation policy (EPDDisplay::ALLOC_AUTO, EPDDisplay::ALLOC_INTERNAL_DMA, EPDDisplay::ALLOC_PSRAM)
+     */
+    void setAllocationPolicy(ALLOC_POLICY policy);
+
+    /**
+     * @brief Use caller-provided framebuffers (policy ALLOC_CALLER)
+     * Must be called before initialize(). Each buffer needs 110 bytes per row:
+     * 58,080 bytes for initialize(), 110 × band_height for initializeBanded().
+     * The buffers are not freed by the display and must outlive it.
+     * With EPD_INTERLEAVED_PLANES both planes share black_buffer, which then
+     * needs twice that size; red_buffer is ignored and may be NULL.
+     * @param black_buffer Black plane
+     * @param red_buffer Red plane
+     */
+    void setFramebuffers(uint8_t *black_buffer, uint8_t *red_buffer);
+
+    /**
+     * @brief Report the memory each framebuffer plane lives in
+     * @param black Filled with the placement of the black plane
+     * @param red Filled with the placement of the red plane
+     */
+    void getBufferPlacement(MEMORY_PLACEMENT *black, MEMORY_PLACEMENT *red);
+
+    /**
+     * @brief Initialize the display with a framebuffer of a few rows only (banded rendering)
+     * Allocates two planes of band_height rows (110 bytes each) instead of the
+     * full 116 KB. The screen is then drawn with renderBanded(); display(),
+     * displayRegion(), displayAsync() and double buffering are not available.
+     * @param band_height Rows per band (1..528); e.g. 48 rows use 10.5 KB
+     * @return true if initialization is successful, false otherwise (also when
+     *         the display is already initialized with another buffer height)
+     */
+    bool initializeBanded(uint16_t band_height);
+
+    /**
+     * @brief Render the screen band by band, upload each band, then refresh the panel
+     * For every band the buffer is cleared to white, draw() is called and the
+     * band is streamed to controller RAM before the next one is drawn. Bands
+     * whose content did not change since the last frame are not sent.
+     * Also works with initialize(): then draw() runs once, followed by display().
+     * @param draw Function drawing the whole screen
+     * @param arg User argument passed to draw()
+     */
+    void renderBanded(DrawCallback draw, void *arg = NULL);
+
     /**
      * @brief Reset the display hardware
+     * Pulses RST, then waits for the controller to release BUSY after its
+     * boot instead of a fixed delay.
      */
     void reset();
 
@@ -144,6 +397,163 @@ public:
      */
     void display();
 
+    /**
+     * @brief Fill the whole screen with one color and refresh the panel
+     * Controller RAM is filled with Auto Write RAM (0x46 / 0x47) patterns, so
+     * only a few command bytes cross the SPI bus.
+     * @param color Fill color (EPDDisplay::WHITE, EPDDisplay::BLACK, EPDDisplay::RED)
+     */
+    void displayFill(COLOR color);
+
+    /**
+     * @brief Upload only a rectangular region of the framebuffers, then refresh the panel
+     * The controller RAM window (0x44/0x45) is narrowed to the byte columns and
+     * rows covering the region, so only those bytes cross the SPI bus. The
+     * rest of controller RAM keeps the previously uploaded frame.
+     * @param x X coordinate of the region's top-left corner
+     * @param y Y coordinate of the region's top-left corner
+     * @param w Region width in pixels
+     * @param h Region height in pixels
+     */
+    void displayRegion(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+    /**
+     * @brief Select the waveform used by display(), displayRegion() and displayAsync()
+     * Frames whose red plane changed since the last upload always use
+     * REFRESH_FULL_TRICOLOR, whatever the selected mode.
+     * @param mode Refresh mode (EPDDisplay::REFRESH_FULL_TRICOLOR, EPDDisplay::REFRESH_FAST_BW, EPDDisplay::REFRESH_PARTIAL_BW)
+     */
+    void setRefreshMode(REFRESH_MODE mode);
+
+    /**
+     * @brief Get the refresh mode selected with setRefreshMode()
+     */
+    REFRESH_MODE getRefreshMode();
+
+    /**
+     * @brief Get the mode actually used by the last refresh (after the red-plane fallback)
+     */
+    REFRESH_MODE getLastRefreshMode();
+
+    /**
+     * @brief Replace the waveform of a refresh mode (e.g. with a panel-specific LUT)
+     * @param mode Refresh mode to configure
+     * @param waveform Waveform data, must outlive the display. NULL restores the built-in waveform.
+     * @return false (waveform unchanged) for an invalid mode, or for a custom LUT
+     *         whose loadSequence sets the "load LUT" bit (0x10)
+     */
+    bool setWaveform(REFRESH_MODE mode, const Waveform *waveform);
+
+    /**
+     * @brief Allocate a second pair of framebuffers for render-while-refreshing
+     * Drawing keeps targeting the draw buffers; commit() hands a finished
+     * frame to the front buffers and refreshes the panel from there. Uses
+     * PSRAM when it is available.
+     * @return true if double buffering is enabled, false if the display is not
+     *         initialized or memory could not be allocated
+     */
+    bool enableDoubleBuffer();
+
+    /**
+     * @brief Free the front buffers and return to single buffering
+     */
+    void disableDoubleBuffer();
+
+    /**
+     * @brief Check whether double buffering is enabled
+     */
+    bool isDoubleBuffered();
+
+    /**
+     * @brief Hand the drawn frame to the panel and keep drawing the next one
+     * Swaps draw and front buffers. If no refresh is running, the new front
+     * frame is uploaded and an asynchronous refresh starts (as displayAsync()).
+     * Otherwise it is queued and started by the first isRefreshing() /
+     * waitRefresh() call that sees the running refresh finish; a newer
+     * commit() replaces a queued frame. Without double buffering this is
+     * displayAsync().
+     * @param preserve true to copy the committed frame into the new draw
+     *        buffers so drawing continues from it, false to skip the copy when
+     *        the next frame is redrawn from scratch
+     * @return true if the frame was started or queued
+     */
+    bool commit(bool preserve = true);
+
+    /**
+     * @brief Read the framebuffer upload counters
+     * display() keeps a hash of every row last sent to controller RAM and skips
+     * rows (and whole planes) whose content did not change.
+     * @param stats Filled with the counters accumulated since the last resetUploadStats()
+     */
+    void getUploadStats(UploadStats *stats);
+
+    /**
+     * @brief Zero the framebuffer upload counters
+     */
+    void resetUploadStats();
+
+    /**
+     * @brief Time breakdown of the last completed frame
+     * A frame is one display(), displayRegion(), displayFill(), clear() or
+     * renderBanded() call, or an asynchronous refresh (displayAsync(),
+     * commit()) up to the point its completion is observed.
+     * @param timing Filled with the breakdown
+     */
+    void getFrameTiming(FrameTiming *timing);
+
+    /**
+     * @brief Set a function to run with the breakdown of every completed frame
+     * @param callback Function to call, or NULL to disable
+     * @param arg User argument passed to the callback
+     */
+    void setFrameTimingCallback(FrameTimingCallback callback, void *arg = NULL);
+
+    /**
+     * @brief Time breakdown of the last controller start (initialize() or wakeUp())
+     * @param timing Filled with the breakdown (all zero before the first start)
+     */
+    void getStartupTiming(StartupTiming *timing);
+
+    /**
+     * @brief Set a function to run with the breakdown of every controller start
+     * @param callback Function to call, or NULL to disable
+     * @param arg User argument passed to the callback
+     */
+    void setStartupTimingCallback(StartupTimingCallback callback, void *arg = NULL);
+
+    /**
+     * @brief Keep the fingerprint of the displayed frame across MCU deep sleep
+     * sleep() saves one hash per band of EPD_FINGERPRINT_BAND_ROWS rows and
+     * plane to the store. After the MCU wakes, initialize() finds the record,
+     * keeps controller RAM (no auto write), and the first display() only
+     * sends the bands that changed, or skips the refresh if none did.
+     * wakeUp() also keeps controller RAM while a store is set. Requires the
+     * panel to stay powered while the MCU sleeps. Call before initialize().
+     * @param store EPDRtcFrameStore, EPDNvsFrameStore or any other EPDFrameStore
+     *              (must stay valid), NULL to disable (the default)
+     */
+    void setFrameStore(EPDFrameStore *store);
+
+    /**
+     * @brief Light-sleep the CPU while a blocking refresh runs (ESP32)
+     * display(), displayRegion(), displayFill(), clear() and renderBanded()
+     * arm BUSY as a GPIO wakeup source and enter light sleep until the
+     * refresh finishes, with the usual BUSY timeout as a timer wakeup. The
+     * time slept is reported in FrameTiming::sleptUs. Other targets keep
+     * polling BUSY.
+     * @param enable true to sleep, false to poll (the default)
+     */
+    void setLightSleep(bool enable);
+
+    /**
+     * @brief Set the guard time after each BUSY release during reset and init
+     * The init sequence waits for the BUSY edge of every step that needs it
+     * (boot, software reset, auto write, LUT load) and only adds this guard
+     * on top. Refresh waits keep their own settle time.
+     * @param ms Guard time in milliseconds (default EPD_INIT_GUARD_MS)
+     */
+    void setInitGuardTime(uint16_t ms);
+
     /**
      * @brief Put the display into sleep mode to save power
      */
@@ -162,6 +572,51 @@ public:
      */
     void wakeUp();
 
+    /**
+     * @brief Start a panel refresh and return without waiting for it to finish
+     * Both framebuffers are uploaded first, so drawing into the framebuffer
+     * while the refresh is in flight is safe and only affects the next frame.
+     * Completion is detected by a BUSY falling-edge interrupt.
+     * display(), clear() and sleep() wait for an in-flight refresh before
+     * touching the controller.
+     * @return true if the refresh was started, false if the display is not ready
+     *         or a refresh is already in progress
+     */
+    bool displayAsync();
+
+    /**
+     * @brief Check whether a refresh started by displayAsync() is still running
+     * The first call that observes completion runs the refresh callback, then
+     * starts a frame queued by commit() if there is one.
+     * @return true while the panel is refreshing or a committed frame is queued
+     */
+    bool isRefreshing();
+
+    /**
+     * @brief Wait for a refresh started by displayAsync() to finish
+     * Sleeps in 1 ms steps (yielding to other tasks) instead of spinning on BUSY.
+     * @param timeout_ms Maximum time to wait in milliseconds
+     * @return true if no refresh is in progress anymore, false on timeout
+     */
+    bool waitRefresh(uint32_t timeout_ms = EPD_BUSY_TIMEOUT_MS);
+
+    /**
+     * @brief Set a function to run when an asynchronous refresh completes
+     * The callback runs in task context, from the isRefreshing() / waitRefresh()
+     * call that observes completion (never from the interrupt).
+     * @param callback Function to call, or NULL to disable
+     * @param arg User argument passed to the callback
+     */
+    void setRefreshCallback(RefreshCallback callback, void *arg = NULL);
+
+    /**
+     * @brief Set a FreeRTOS task to notify (xTaskNotifyGive) when an asynchronous refresh completes
+     * The notification is given directly from the BUSY interrupt, so the task
+     * can block in ulTaskNotifyTake() without polling. Ignored on non-ESP32 builds.
+     * @param task_handle TaskHandle_t of the task to notify, or NULL to disable
+     */
+    void setRefreshNotifyTask(void *task_handle);
+
     /** ***************************************
     BASIC FUNCTIONS
     *****************************************/
@@ -177,6 +632,17 @@ public:
      * @param color Color (EPDDisplay::WHITE, EPDDisplay::BLACK, EPDDisplay::RED)
      */
     void fillScreen(COLOR color);
+    /**
+     * @brief Fill a rectangle with specified color
+     * Rows are written byte-wise (masked edge bytes, memset between them) and
+     * clipped to the display; rotation and mirroring apply.
+     * @param x X coordinate of the top-left corner
+     * @param y Y coordinate of the top-left corner
+     * @param w Width in pixels
+     * @param h Height in pixels
+     * @param color Color (EPDDisplay::WHITE, EPDDisplay::BLACK, EPDDisplay::RED)
+     */
+    void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, COLOR color);
 
     /**
      * @brief Set display rotation
@@ -254,6 +720,28 @@ public:
      */
     void drawLine(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend, COLOR color, uint8_t line_width, LINE_STYLE line_style);
 
+    /**
+     * @brief Draw a horizontal run of pixels
+     * Written byte-wise (masked edge bytes, memset between them) and clipped
+     * to the display; with ROTATE_90 / ROTATE_270 it becomes a buffer column.
+     * @param x X coordinate of the leftmost pixel
+     * @param y Y coordinate of the span
+     * @param length Number of pixels
+     * @param color Color of the span (EPDDisplay::WHITE, EPDDisplay::BLACK, EPDDisplay::RED)
+     */
+    void drawHSpan(uint16_t x, uint16_t y, uint16_t length, COLOR color);
+
+    /**
+     * @brief Draw a vertical run of pixels
+     * Clipped to the display; one masked byte per row, or a byte-wise buffer
+     * row with ROTATE_90 / ROTATE_270.
+     * @param x X coordinate of the span
+     * @param y Y coordinate of the topmost pixel
+     * @param length Number of pixels
+     * @param color Color of the span (EPDDisplay::WHITE, EPDDisplay::BLACK, EPDDisplay::RED)
+     */
+    void drawVSpan(uint16_t x, uint16_t y, uint16_t length, COLOR color);
+
     /**
      * @brief Draw a point on the display
      * @param Xpoint X coordinate of the point
@@ -429,12 +917,22 @@ public:
     void drawDigitalClock7Segment(uint16_t x_start, uint16_t y_start, uint16_t segment_width, uint16_t segment_height, uint8_t hour, uint8_t minute, uint8_t second, COLOR color_on, COLOR color_off, bool show_seconds = true, bool format_24h = true);
 
 private:
+    // Unchecked pixel path of the drawing primitives (EPDPixelWriter.h)
+    friend class EPDPixelWriter;
+    // Times the group's waits and its shared reset with a panel's transport
+    friend class EPDPanelGroup;
+
     /** ***************************************
     VARIABLES
     *****************************************/
 
-    uint8_t *blackBuffer;
-    uint8_t *redBuffer;
+    uint8_t *blackBuffer; // Byte i of a plane is at [i * EPD_PLANE_STRIDE]
+    uint8_t *redBuffer;   // blackBuffer + 1 with EPD_INTERLEAVED_PLANES
+    uint8_t *frontBlack; // Double buffering: frame being shown / queued (NULL when disabled)
+    uint8_t *frontRed;
+    ALLOC_POLICY allocPolicy;
+    bool ownsBuffers; // blackBuffer/redBuffer were allocated here (not ALLOC_CALLER)
+    uint32_t *rowHash; // Hash of each row last sent to controller RAM: [plane * heightByte + row], 0 = unknown
     bool isInitialized;
     bool isSleep;
 
@@ -444,9 +942,31 @@ private:
     uint16_t heightByte;
     uint16_t widthMemory;
     uint16_t heightMemory;
+    uint16_t bufferRowOffset; // First buffer row held in blackBuffer/redBuffer (banded rendering)
+    uint16_t bufferRows;      // Rows held in blackBuffer/redBuffer (heightByte unless banded)
+    uint16_t bandHeight;      // Band height for renderBanded(), 0 = full framebuffer
     uint8_t rotate;
     uint8_t mirror;
 
+    // Rotation + mirror folded into one affine map from user to buffer
+    // coordinates, rebuilt by setRotation() / setMirror():
+    //   X = originX + x * xStepX + y * yStepX
+    //   Y = originY + x * xStepY + y * yStepY
+    // Every step is -1, 0 or +1. limitX / limitY bound the user coordinates
+    // that land inside the buffer.
+    typedef struct
+    {
+        int16_t originX;
+        int16_t originY;
+        int8_t xStepX;
+        int8_t xStepY;
+        int8_t yStepX;
+        int8_t yStepY;
+        uint16_t limitX;
+        uint16_t limitY;
+    } Transform;
+    Transform transform;
+
     // Pins
     int m_BUSY_pin;
     int m_RST_pin;
@@ -455,6 +975,68 @@ private:
     int m_CLK_pin;
     int m_DIN_pin;
 
+    // Rectangle in buffer coordinates (pixels, after rotation/mirror).
+    // Empty when xStart > xEnd (start = 0xFFFF, end = 0).
+    typedef struct
+    {
+        uint16_t xStart;
+        uint16_t xEnd;
+        uint16_t yStart;
+        uint16_t yEnd;
+    } DirtyRect;
+
+    DirtyRect dirty;      // Drawn into blackBuffer/redBuffer since the last upload or commit
+    DirtyRect frontDirty; // Front buffers not yet uploaded (double buffering)
+    bool ramSynced;       // Controller RAM holds the last uploaded frame (false after hwInit)
+    bool commitPending;   // commit() made while a refresh was running: upload when it ends
+    UploadStats uploadStats;
+
+    // SPI link to the controller
+    EPDTransport *transport;
+    bool ownsTransport;
+
+    // Asynchronous refresh state (see displayAsync())
+    volatile bool refreshActive;   // Refresh triggered and completion not yet reported
+    volatile bool refreshBusyEdge; // Set by the BUSY falling-edge interrupt
+    uint32_t refreshStart;         // transport->nowMs() at activation
+    RefreshCallback refreshCallback;
+    void *refreshCallbackArg;
+    void *refreshNotifyTask;
+
+    // Refresh mode / waveform state (see EPDDisplay_Waveforms.cpp)
+    REFRESH_MODE refreshMode;
+    REFRESH_MODE lastRefreshMode;
+    const Waveform *waveforms[3];   // Indexed by REFRESH_MODE
+    const Waveform *loadedWaveform; // Waveform currently in the LUT register, NULL if unknown
+    uint8_t activeUpdateSequence;   // 0x22 value used by TriggerRefresh()
+
+    // Frame timing (see EPDDisplay_Timing.cpp)
+    FrameTiming frameTiming;     // Frame in progress: busy / settle / render accumulate here
+    FrameTiming lastFrameTiming; // Last completed frame
+    uint32_t frameStartUs;       // nowUs() at the start of the frame, moved past draw callbacks
+    uint32_t frameTriggerUs;     // nowUs() at the refresh trigger of an asynchronous frame
+    uint32_t lastFrameEndUs;     // nowUs() when the previous frame completed
+    bool frameOpen;
+    FrameTimingCallback frameTimingCallback;
+    void *frameTimingCallbackArg;
+    StartupTiming startupTiming;   // Last controller start
+    StartupTimingCallback startupTimingCallback;
+    void *startupTimingCallbackArg;
+    uint16_t initGuardMs;          // Guard after BUSY release during reset / init
+    bool lightSleep;               // Blocking refresh waits light-sleep the CPU
+
+    // Deep-sleep resume (see EPDDisplay_Resume.cpp)
+    typedef struct
+    {
+        uint32_t magic;                             // EPD_FINGERPRINT_MAGIC, 0 = none / used
+        uint32_t bands[2][EPD_FINGERPRINT_BANDS];   // Per plane and band, 0 = band unknown
+        uint32_t check;                             // FNV-1a of the fields above
+    } FrameFingerprint;
+
+    EPDFrameStore *frameStore;
+    FrameFingerprint *fingerprint; // Loaded at initialize(), consumed by the first full upload
+    bool resumeFrame;              // Controller RAM kept across a sleep: display() may skip the refresh
+
     /*****************************************
     HARDWARE FUNCTIONS
     *****************************************/
@@ -465,6 +1047,17 @@ private:
      */
     bool checkDisplayReady();
 
+    /**
+     * @brief Allocate the framebuffers for the given number of rows and start the hardware
+     */
+    bool initializeWithRows(uint16_t rows);
+
+    /**
+     * @brief Check for banded mode, where the framebuffer holds no full frame
+     * @return true if banded (with debug message)
+     */
+    bool isBanded();
+
     /**
      * @brief Send command to EPD controller
      * @param Reg Command register value to send
@@ -477,16 +1070,251 @@ private:
      */
     void SendData(uint8_t Data);
 
+    /**
+     * @brief Begin a data burst: DC and CS stay asserted until EndData()
+     */
+    void BeginData();
+
+    /**
+     * @brief Stream data bytes inside the current burst
+     * @param Data Pointer to the bytes to send
+     * @param Length Number of bytes
+     * @param Invert If true, each byte is sent as its bitwise NOT
+     */
+    void SendDataSpan(const uint8_t *Data, uint32_t Length, bool Invert);
+
+    /**
+     * @brief Stream Length bytes of a framebuffer plane (EPD_PLANE_STRIDE apart) inside the current burst
+     * @param Data Pointer to the first plane byte
+     * @param Length Number of plane bytes
+     * @param Invert If true, each byte is sent as its bitwise NOT
+     */
+    void SendPlaneSpan(const uint8_t *Data, uint32_t Length, bool Invert);
+
+    /**
+     * @brief Stream the same data byte Count times inside the current burst
+     * @param Data Byte to repeat
+     * @param Count Number of bytes
+     */
+    void SendDataRepeat(uint8_t Data, uint32_t Count);
+
+    /**
+     * @brief End the current data burst
+     */
+    void EndData();
+
     /**
      * @brief Wait for busy signal to clear
+     * @param guard_ms Settle time after the release, counted as settle time
+     * @param sleep true to light-sleep until the release (refresh waits, see setLightSleep())
+     */
+    void ReadBusy(uint32_t guard_ms = EPD_BUSY_SETTLE_MS, bool sleep = false);
+
+    /**
+     * @brief Fixed delay, counted as settle time of the current frame
+     */
+    void Settle(uint32_t ms);
+
+    /**
+     * @brief Start timing a frame (no-op if one is already open)
+     */
+    void beginFrame();
+
+    /**
+     * @brief Close the current frame: compute the breakdown and run the callback
+     */
+    void endFrame();
+
+    /**
+     * @brief Send the framebuffer planes to controller RAM (0x24 / 0x26)
+     * Uploads only the dirty region when controller RAM is known to hold the
+     * previous frame, otherwise the full frame.
+     * @param fromFront true to send the front buffers and frontDirty (double buffering)
+     * @return true if any red plane byte was sent
+     */
+    bool UploadFrame(bool fromFront = false);
+
+    /**
+     * @brief Send a window of both planes to controller RAM, skipping unchanged rows
+     * @param black Black plane to send
+     * @param red Red plane to send
+     * @param xByteStart First byte column (0..widthByte-1)
+     * @param xByteEnd Last byte column (inclusive)
+     * @param yStart First buffer row
+     * @param yEnd Last buffer row (inclusive)
+     * @param rowsComplete true if, after the upload, the window rows in controller RAM
+     *        match the whole buffer rows (nothing pending outside the window)
+     * @return true if any red plane byte was sent
+     */
+    bool UploadWindow(const uint8_t *black, const uint8_t *red, uint16_t xByteStart, uint16_t xByteEnd, uint16_t yStart, uint16_t yEnd, bool rowsComplete = true);
+
+    /**
+     * @brief Send the changed rows of one plane window and update the row hashes
+     * @param command RAM write command (0x24 or 0x26)
+     * @param buffer Plane to send
+     * @param plane Row hash table index (0 = black, 1 = red)
+     * @param invert Send each byte inverted
+     * @return true if any byte was sent
+     */
+    bool UploadPlane(uint8_t command, const uint8_t *buffer, uint8_t plane, bool invert,
+                     uint16_t xByteStart, uint16_t xByteEnd, uint16_t yStart, uint16_t yEnd, bool rowsComplete);
+
+    /**
+     * @brief Fill one plane of controller RAM with a uniform value (Auto Write RAM)
+     * unless the row hashes show it already holds that value
+     * @param command RAM write command of the plane (0x24 or 0x26)
+     * @param plane Row hash table index (0 = black, 1 = red)
+     * @param ramValue Byte value for controller RAM (0x00 or 0xFF)
+     * @param bufferValue Same value in framebuffer encoding
+     * @return true if the plane was written
+     */
+    bool AutoFillPlane(uint8_t command, uint8_t plane, uint8_t ramValue, uint8_t bufferValue);
+
+    /**
+     * @brief Fill controller RAM with all 0s or all 1s in hardware
+     * @param command 0x46 (Red RAM) or 0x47 (BW RAM)
+     * @param value 0x00 or 0xFF
+     */
+    void AutoWriteRam(uint8_t command, uint8_t value);
+
+    /**
+     * @brief Program the RAM window and stream a block of rows of one plane
+     */
+    void SendPlaneRows(uint8_t command, const uint8_t *buffer, bool invert,
+                       uint16_t xByteStart, uint16_t xByteEnd, uint16_t yStart, uint16_t yEnd);
+
+    /**
+     * @brief Forget what controller RAM holds (after hwInit)
+     */
+    void invalidateRowHashes();
+
+    /**
+     * @brief Record that controller RAM holds an all-white frame (after clear)
+     */
+    void setRowHashesWhite();
+
+    /**
+     * @brief Program the controller RAM window (0x44/0x45) and address counters (0x4E/0x4F)
+     * @param xByteStart First byte column
+     * @param xByteEnd Last byte column (inclusive)
+     * @param yStart First buffer row
+     * @param yEnd Last buffer row (inclusive)
+     */
+    void SetRamWindow(uint16_t xByteStart, uint16_t xByteEnd, uint16_t yStart, uint16_t yEnd);
+
+    /**
+     * @brief Map user coordinates to buffer coordinates (rotation + mirror)
+     * @return false if the point falls outside the buffer
+     */
+    bool transformPoint(uint16_t x, uint16_t y, uint16_t *X, uint16_t *Y);
+
+    /**
+     * @brief Rebuild the transform from rotate and mirror
+     */
+    void updateTransform();
+
+    /**
+     * @brief Mark the whole buffer as dirty
+     */
+    void markAllDirty();
+
+    /**
+     * @brief Mark the buffer as in sync with controller RAM
+     */
+    void clearDirty();
+
+    /**
+     * @brief Set a rectangle to empty
+     */
+    static void emptyRect(DirtyRect *rect);
+
+    /**
+     * @brief Grow a rectangle to also cover another one
+     */
+    static void unionRect(DirtyRect *rect, const DirtyRect *other);
+
+    /**
+     * @brief Upload the draw buffers (or the front buffers) and start a refresh without waiting
+     * @param fromFront true to send the front buffers of a commit()
+     */
+    void StartRefresh(bool fromFront);
+
+    /**
+     * @brief Allocate one plane according to a policy
+     * @param size Bytes
+     * @param policy ALLOC_AUTO, ALLOC_INTERNAL_DMA or ALLOC_PSRAM
+     * @return Plane, or NULL if the policy cannot be satisfied
+     */
+    uint8_t *allocPlane(uint32_t size, ALLOC_POLICY policy);
+
+    /**
+     * @brief Release a plane from allocPlane()
+     */
+    static void freePlane(uint8_t *plane);
+
+    /**
+     * @brief Allocate a black/red plane pair (one interleaved block with EPD_INTERLEAVED_PLANES)
+     * @param size Bytes per plane
+     * @return false (and both NULL) if the policy cannot be satisfied
+     */
+    bool allocPlanePair(uint8_t **black, uint8_t **red, uint32_t size, ALLOC_POLICY policy);
+
+    /**
+     * @brief Release a pair from allocPlanePair()
+     */
+    static void freePlanePair(uint8_t *black, uint8_t *red);
+
+    /**
+     * @brief Set every byte of the planes in memory, without touching the dirty rectangle
+     */
+    void fillPlanes(uint8_t black, uint8_t red);
+
+    /**
+     * @brief Memory a pointer lives in
+     */
+    static MEMORY_PLACEMENT placementOf(const void *ptr);
+
+    /**
+     * @brief Allocate blackBuffer/redBuffer (or take the caller's) for the given rows
+     */
+    bool allocateFramebuffers(uint32_t size);
+
+    /**
+     * @brief Release blackBuffer/redBuffer if they were allocated here
+     */
+    void freeFramebuffers();
+
+    /**
+     * @brief Release the front buffers of double buffering
+     */
+    void freeBackBuffers();
+
+    /**
+     * @brief Load the waveform of a refresh mode if it is not loaded yet, and
+     * make its update sequence the one used by TriggerRefresh()
+     */
+    void LoadWaveform(REFRESH_MODE mode);
+
+    /**
+     * @brief Built-in waveform for a refresh mode
+     */
+    static const Waveform *defaultWaveform(REFRESH_MODE mode);
+
+    /**
+     * @brief Start the panel refresh (0x22 / 0x20) without waiting
      */
-    void ReadBusy();
+    void TriggerRefresh();
 
     /**
-     * @brief Write a byte via SPI
-     * @param value Byte value to write
+     * @brief BUSY falling-edge interrupt handler
+     * @param arg The EPDDisplay instance
      */
-    void SPI_WriteByte(uint8_t value);
+    static void BusyISR(void *arg);
+
+    /**
+     * @brief Close an asynchronous refresh: detach the interrupt and run the callback
+     */
+    void finishRefresh();
 
     /*****************************************
     Utils FUNCTIONS
@@ -506,8 +1334,38 @@ private:
      * @brief Send the full hardware initialization command sequence to the controller.
      * Called by initialize() and wakeUp(). Extracted so that wakeUp() can
      * re-apply all settings after a reset without re-allocating buffers.
+     * @param keepRam true to skip the RAM auto write (see startController())
+     */
+    void hwInit(bool keepRam = false);
+
+    /**
+     * @brief reset() + hwInit(), timed into startupTiming
+     * @param keepRam true to skip the RAM auto write and keep the row hashes
+     *                (controller RAM survived deep sleep, see setFrameStore())
+     */
+    void startController(bool keepRam = false);
+
+    /**
+     * @brief Save the fingerprint of controller RAM to the frame store (from sleep())
+     */
+    void saveFingerprint();
+
+    /**
+     * @brief Load a valid fingerprint from the frame store and erase it there
+     * @return true if one was found
+     */
+    bool loadFingerprint();
+
+    /**
+     * @brief Restore the row hashes of every band whose fingerprint still matches the buffers
+     * Consumes the loaded fingerprint; unmatched bands keep unknown (0) hashes.
+     */
+    void restoreRowHashes(const uint8_t *black, const uint8_t *red);
+
+    /**
+     * @brief FNV-1a over one buffer row, never 0 (0 marks an unknown row)
      */
-    void hwInit();
+    static uint32_t hashRow(const uint8_t *row, uint16_t length, uint8_t stride = 1);
 
     /**
      * @brief Draw a single 7-segment digit
@@ -0,0 +1,201 @@
+#ifndef __EPDDISPLAYT_H
+#define __EPDDISPLAYT_H
+#include "EPDDisplay.h"
+
+#if defined(ESP32)
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#endif
+
+/**
+ * @file EPDDisplayT.h
+ * @brief Compile-time pin variant of EPDDisplay.
+ *
+ * EPDDisplay keeps pin numbers in runtime ints, so every SPI bit goes through
+ * digitalWrite(): a pin-number lookup, a range check and a read-modify-write.
+ * When the wiring is known at compile time, EPDDisplayT resolves each pin to
+ * a constant register mask instead, and the bit-banged transport writes the
+ * ESP32 GPIO set/clear registers (W1TS / W1TC) directly with the 8-bit shift
+ * loop fully unrolled.
+ *
+ * Usage:
+ *   EPDDisplayT<4, 16, 17, 5, 18, 23> display; // BUSY, RST, DC, CS, CLK, DIN
+ *   display.initialize();
+ *
+ * EPDDisplayT is an EPDDisplay, so all drawing functions and any code taking
+ * an EPDDisplay & keep working unchanged. On non-ESP32 targets (including
+ * host builds) the pins fall back to digitalWrite().
+ */
+
+/**
+ * @brief One output pin resolved at compile time
+ * @tparam PIN GPIO number
+ */
+template <int PIN>
+struct EPDFastPin
+{
+    static_assert(PIN >= 0 && PIN < 64, "EPDFastPin: invalid GPIO number");
+#if defined(ESP32) && !(defined(GPIO_OUT1_W1TS_REG) && defined(GPIO_OUT1_W1TC_REG))
+    // Without the second bank's registers set() / clear() could not drive it
+    static_assert(PIN < 32, "EPDFastPin: this target has no GPIO_OUT1 registers for pins 32-63");
+#endif
+
+    static inline void set()
+    {
+#if defined(ESP32)
+        if (PIN < 32)
+            REG_WRITE(GPIO_OUT_W1TS_REG, 1UL << (PIN & 31));
+#ifdef GPIO_OUT1_W1TS_REG
+        else
+            REG_WRITE(GPIO_OUT1_W1TS_REG, 1UL << (PIN & 31));
+#endif
+#else
+        digitalWrite(PIN, HIGH);
+#endif
+    }
+
+    static inline void clear()
+    {
+#if defined(ESP32)
+        if (PIN < 32)
+            REG_WRITE(GPIO_OUT_W1TC_REG, 1UL << (PIN & 31));
+#ifdef GPIO_OUT1_W1TC_REG
+        else
+            REG_WRITE(GPIO_OUT1_W1TC_REG, 1UL << (PIN & 31));
+#endif
+#else
+        digitalWrite(PIN, LOW);
+#endif
+    }
+
+    static inline void write(bool level)
+    {
+        if (level)
+            set();
+        else
+            clear();
+    }
+};
+
+/**
+ * @brief Bit-banged SPI transport with compile-time pins
+ *
+ * Same wire protocol as EPDBitBangTransport (Mode 0, MSB first), but each
+ * GPIO write is a single store to a set/clear register and the shift loop
+ * is unrolled, so a byte costs 24 register stores and no function calls.
+ */
+template <int DC, int CS, int CLK, int DIN>
+class EPDFastGpioTransport : public EPDTransport
+{
+public:
+    bool begin()
+    {
+        pinMode(DC, OUTPUT);
+        pinMode(CLK, OUTPUT);
+        pinMode(DIN, OUTPUT);
+        pinMode(CS, OUTPUT);
+        EPDFastPin<CS>::set();
+        EPDFastPin<CLK>::clear();
+        return true;
+    }
+
+    void writeCommand(uint8_t command)
+    {
+        EPDFastPin<DC>::clear();
+        EPDFastPin<CS>::clear();
+        shiftByte(command);
+        EPDFastPin<CS>::set();
+    }
+
+    void writeData(uint8_t data)
+    {
+        EPDFastPin<DC>::set();
+        EPDFastPin<CS>::clear();
+        shiftByte(data);
+        EPDFastPin<CS>::set();
+    }
+
+    void beginData()
+    {
+        EPDFastPin<DC>::set();
+        EPDFastPin<CS>::clear();
+    }
+
+    void writeDataSpan(const uint8_t *data, uint32_t length, bool invert = false)
+    {
+        uint8_t mask = invert ? 0xFF : 0x00;
+        for (uint32_t i = 0; i < length; i++)
+        {
+            shiftByte(data[i] ^ mask);
+        }
+    }
+
+    void writeDataRepeat(uint8_t value, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            shiftByte(value);
+        }
+    }
+
+    void endData()
+    {
+        EPDFastPin<CS>::set();
+    }
+
+private:
+    // DIN = bit, then a CLK pulse: the controller latches DIN on the rising edge
+    template <int BIT>
+    static inline void shiftBit(uint8_t value)
+    {
+        EPDFastPin<DIN>::write(value & (1 << BIT));
+        EPDFastPin<CLK>::set();
+        EPDFastPin<CLK>::clear();
+    }
+
+    static inline void shiftByte(uint8_t value)
+    {
+        shiftBit<7>(value);
+        shiftBit<6>(value);
+        shiftBit<5>(value);
+        shiftBit<4>(value);
+        shiftBit<3>(value);
+        shiftBit<2>(value);
+        shiftBit<1>(value);
+        shiftBit<0>(value);
+    }
+};
+
+/**
+ * @brief Owner of the transport of an EPDDisplayT
+ *
+ * A base class listed before EPDDisplay, so the transport is constructed
+ * before the display and destroyed after it: the display can use it from
+ * its constructor to its destructor.
+ */
+template <int DC, int CS, int CLK, int DIN>
+class EPDFastGpioTransportHolder
+{
+protected:
+    EPDFastGpioTransport<DC, CS, CLK, DIN> m_fastTransport;
+};
+
+/**
+ * @brief EPDDisplay with pins fixed at compile time
+ * @tparam BUSY BUSY signal pin
+ * @tparam RST RST signal pin
+ * @tparam DC DC signal pin
+ * @tparam CS CS signal pin
+ * @tparam CLK CLK signal pin (SCK)
+ * @tparam DIN DIN signal pin (MOSI)
+ */
+template <int BUSY, int RST, int DC, int CS, int CLK, int DIN>
+class EPDDisplayT : private EPDFastGpioTransportHolder<DC, CS, CLK, DIN>, public EPDDisplay
+{
+public:
+    EPDDisplayT() : EPDDisplay(BUSY, RST, &this->m_fastTransport)
+    {
+    }
+};
+
+#endif // __EPDDISPLAYT_H
@@ -0,0 +1,171 @@
+/**
+ * @file EPDDisplay_Async.cpp
+ * @brief Non-blocking refresh: displayAsync(), isRefreshing(), waitRefresh().
+ *
+ * A tricolor refresh keeps the controller busy for ~15–20 s. display() polls
+ * BUSY for that whole time; displayAsync() instead uploads both planes,
+ * arms a falling-edge interrupt on BUSY (HIGH = busy, LOW = idle) and
+ * returns right after the activation command.
+ *
+ * Completion paths:
+ *   - BusyISR() sets refreshBusyEdge and, if a task was registered with
+ *     setRefreshNotifyTask(), gives it a FreeRTOS task notification.
+ *   - isRefreshing() / waitRefresh() observe the flag in task context, detach
+ *     the interrupt and run the refresh callback exactly once.
+ *   - If no edge arrives (interrupt missed, or host build without one), the
+ *     BUSY level is trusted once EPD_BUSY_RISE_MS has passed since activation,
+ *     which gives the controller time to raise BUSY in the first place.
+ *
+ * Framebuffer access during a refresh: the planes have already been copied
+ * into controller RAM when the refresh starts, so drawing calls are allowed
+ * and only affect the next frame. Commands to the controller (display(),
+ * clear(), sleep()) wait for the refresh first; displayAsync() refuses to
+ * start a second refresh and returns false.
+ */
+#include "EPDDisplay.h"
+
+// Time after activation before a LOW BUSY level is taken as "done"
+#define EPD_BUSY_RISE_MS 10
+
+bool EPDDisplay::displayAsync()
+{
+    if (!checkDisplayReady())
+    {
+        return false;
+    }
+
+    if (isBanded())
+    {
+        return false;
+    }
+
+    if (isRefreshing())
+    {
+        Debug("displayAsync: refresh already in progress\r\n");
+        return false;
+    }
+
+    StartRefresh(false);
+    Debug("display (async)\r\n");
+    return true;
+}
+
+void EPDDisplay::StartRefresh(bool fromFront)
+{
+    beginFrame();
+    bool redChanged = UploadFrame(fromFront);
+    LoadWaveform(redChanged ? EPDDisplay::REFRESH_FULL_TRICOLOR : refreshMode);
+
+    refreshBusyEdge = false;
+    refreshActive = true;
+    refreshStart = transport->nowMs();
+    transport->attachBusyInterrupt(EPDDisplay::BusyISR, this);
+
+    TriggerRefresh();
+    frameTriggerUs = transport->nowUs();
+}
+
+bool EPDDisplay::isRefreshing()
+{
+    if (!refreshActive)
+    {
+        return false;
+    }
+
+    if (!refreshBusyEdge)
+    {
+        uint32_t elapsed = transport->nowMs() - refreshStart;
+        bool busyHigh = (elapsed < EPD_BUSY_RISE_MS) || transport->isBusy();
+        if (busyHigh && elapsed <= EPD_BUSY_TIMEOUT_MS)
+        {
+            return true;
+        }
+        if (busyHigh)
+        {
+            Debug("e-Paper BUSY timeout!\r\n");
+        }
+    }
+
+    finishRefresh();
+
+    // A frame committed during the refresh goes out now
+    if (commitPending)
+    {
+        commitPending = false;
+        StartRefresh(true);
+        Debug("display (queued commit)\r\n");
+        return true;
+    }
+    return false;
+}
+
+bool EPDDisplay::waitRefresh(uint32_t timeout_ms)
+{
+    uint32_t start = transport->nowMs();
+    while (isRefreshing())
+    {
+        if (transport->nowMs() - start >= timeout_ms)
+        {
+            return false;
+        }
+        transport->delayMs(1); // Yields to other FreeRTOS tasks
+    }
+    return true;
+}
+
+void EPDDisplay::setRefreshCallback(RefreshCallback callback, void *arg)
+{
+    refreshCallback = callback;
+    refreshCallbackArg = arg;
+}
+
+void EPDDisplay::setRefreshNotifyTask(void *task_handle)
+{
+    refreshNotifyTask = task_handle;
+}
+
+void IRAM_ATTR EPDDisplay::BusyISR(void *arg)
+{
+    EPDDisplay *self = (EPDDisplay *)arg;
+    if (!self->refreshActive || self->refreshBusyEdge)
+    {
+        return;
+    }
+    self->refreshBusyEdge = true;
+
+#if defined(ESP32)
+    if (self->refreshNotifyTask != NULL)
+    {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR((TaskHandle_t)self->refreshNotifyTask, &woken);
+        if (woken)
+        {
+            portYIELD_FROM_ISR();
+        }
+    }
+#endif
+}
+
+void EPDDisplay::finishRefresh()
+{
+    transport->detachBusyInterrupt();
+
+#if defined(ESP32)
+    // Completion detected without the edge: the task was not notified yet
+    if (!refreshBusyEdge && refreshNotifyTask != NULL)
+    {
+        xTaskNotifyGive((TaskHandle_t)refreshNotifyTask);
+    }
+#endif
+
+    refreshActive = false;
+    refreshBusyEdge = false;
+    frameTiming.busyUs += transport->nowUs() - frameTriggerUs;
+    endFrame();
+    Debug("e-Paper refresh complete\r\n");
+
+    if (refreshCallback != NULL)
+    {
+        refreshCallback(this, refreshCallbackArg);
+    }
+}
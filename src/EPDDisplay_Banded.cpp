@@ -0,0 +1,119 @@
+/**
+ * @file EPDDisplay_Banded.cpp
+ * @brief Banded rendering: draw and upload the screen in horizontal strips.
+ *
+ * initializeBanded() allocates planes of band_height rows instead of the
+ * whole 528-row frame. renderBanded() then walks the screen from the top:
+ *
+ *   for each band (buffer rows bandStart .. bandStart + band_height - 1):
+ *     - point the framebuffer at the band (bufferRowOffset / bufferRows)
+ *     - clear it to white and call the application's draw callback
+ *     - stream the band into controller RAM through the RAM window
+ *   then trigger one refresh for the whole frame.
+ *
+ * Clipping happens in drawPixel() and EPDPixelWriter::begin(), after
+ * rotation and mirroring, so every drawing primitive (shapes, text, clocks,
+ * bitmaps) keeps working unchanged: pixels outside the current band are
+ * simply dropped. The draw callback must
+ * therefore be deterministic — it runs once per band and has to produce the
+ * same frame each time.
+ *
+ * Bands are uploaded with the same row hashing as display(), so bands whose
+ * content did not change since the last frame cost no SPI traffic.
+ */
+#include "EPDDisplay.h"
+
+bool EPDDisplay::initializeBanded(uint16_t band_height)
+{
+    if (band_height == 0)
+    {
+        Debug("band_height must be at least 1\r\n");
+        return false;
+    }
+    if (band_height > heightByte)
+    {
+        band_height = heightByte;
+    }
+    if (isInitialized)
+    {
+        if (band_height != bandHeight)
+        {
+            // The planes are already allocated with another height
+            Debug("initializeBanded: already initialized with other bands\r\n");
+            return false;
+        }
+        return initializeWithRows(band_height);
+    }
+
+    bandHeight = band_height;
+    if (!initializeWithRows(band_height))
+    {
+        bandHeight = 0;
+        return false;
+    }
+    return true;
+}
+
+void EPDDisplay::renderBanded(DrawCallback draw, void *arg)
+{
+    if (draw == NULL)
+    {
+        Debug("renderBanded: no draw callback\r\n");
+        return;
+    }
+    if (!checkDisplayReady())
+    {
+        return;
+    }
+
+    if (bandHeight == 0)
+    {
+        // Full framebuffer: a single "band"
+        fillScreen(EPDDisplay::WHITE);
+        draw(this, arg);
+        display();
+        return;
+    }
+    waitRefresh();
+    beginFrame();
+
+    bool redChanged = false;
+    for (uint16_t bandStart = 0; bandStart < heightByte; bandStart += bandHeight)
+    {
+        bufferRowOffset = bandStart;
+        bufferRows = (heightByte - bandStart < bandHeight) ? heightByte - bandStart : bandHeight;
+
+        // Drawing is render time, not upload time
+        uint32_t drawStart = transport->nowUs();
+        fillScreen(EPDDisplay::WHITE);
+        draw(this, arg);
+        uint32_t drawUs = transport->nowUs() - drawStart;
+        frameTiming.renderUs += drawUs;
+        frameStartUs += drawUs;
+
+        if (UploadWindow(blackBuffer, redBuffer, 0, widthByte - 1, bandStart, bandStart + bufferRows - 1))
+        {
+            redChanged = true;
+        }
+    }
+    bufferRowOffset = 0;
+    bufferRows = bandHeight;
+    ramSynced = true;
+    clearDirty();
+
+    LoadWaveform(redChanged ? EPDDisplay::REFRESH_FULL_TRICOLOR : refreshMode);
+    TriggerRefresh();
+    ReadBusy(EPD_BUSY_SETTLE_MS, lightSleep);
+    endFrame();
+    Debug("display (banded)\r\n");
+}
+
+bool EPDDisplay::isBanded()
+{
+    if (bandHeight != 0)
+    {
+        Debug("Not available in banded mode, use renderBanded()\r\n");
+        return true;
+    }
+    return false;
+}
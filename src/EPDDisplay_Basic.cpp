@@ -2,74 +2,125 @@
  * @file EPDDisplay_Basic.cpp
  * @brief Fundamental drawing operations: pixel, fill, bitmap, rotation, mirroring.
  *
- * drawPixel() is the single write path for all drawing primitives.
- * It applies rotation and mirror transforms before computing the buffer address,
- * then sets bits in both blackBuffer and redBuffer according to the color.
+ * drawPixel() is the safe public write path: it validates every call.
+ * Primitives that know their extent (shapes, text, drawBitmap()) clip once
+ * and write through EPDPixelWriter instead, with the same mapping.
+ * setRotation() / setMirror() fold both transforms into one affine map
+ * (updateTransform()), so drawPixel() maps a point with two multiply-adds
+ * and one range check instead of two switches, then sets bits in both
+ * blackBuffer and redBuffer according to the color.
+ * It also grows the dirty rectangle that display() uses to limit the upload
+ * to the part of the frame that was actually drawn.
+ *
+ * fillScreen() sets each plane with one memset(); fillRect() fills buffer
+ * rows with memset() between masked edge bytes (EPDPixelWriter::fill()).
  *
  * Buffer bit address formula (after transform):
- *   Addr  = X / 8 + Y * widthByte   (widthByte = 110 for 880-px width)
+ *   Addr  = (X / 8 + Y * widthByte) * EPD_PLANE_STRIDE   (widthByte = 110 for 880-px width)
  *   Bit   = 0x80 >> (X % 8)         (MSB = leftmost pixel in the byte)
+ * With EPD_INTERLEAVED_PLANES the stride is 2 and redBuffer = blackBuffer + 1,
+ * so the black and red byte of a pixel share a cache line.
  */
-#include "EPDDisplay.h"
+#include "EPDPixelWriter.h"
 
-void EPDDisplay::drawPixel(uint16_t x, uint16_t y, COLOR color)
+void EPDDisplay::updateTransform()
 {
-    if (x > width || y > height)
-    {
-        Debug("Exceeding display boundaries\r\n");
-        return;
-    }
-    uint16_t X, Y;
+    Transform t;
+    memset(&t, 0, sizeof(t));
     switch (rotate)
     {
-    case EPDDisplay::ROTATE_0:
-        X = x;
-        Y = y;
+    case EPDDisplay::ROTATE_90: // X = W - 1 - y, Y = x
+        t.originX = widthMemory - 1;
+        t.yStepX = -1;
+        t.xStepY = 1;
         break;
-    case EPDDisplay::ROTATE_90:
-        X = widthMemory - y - 1;
-        Y = x;
+    case EPDDisplay::ROTATE_180: // X = W - 1 - x, Y = H - 1 - y
+        t.originX = widthMemory - 1;
+        t.xStepX = -1;
+        t.originY = heightMemory - 1;
+        t.yStepY = -1;
         break;
-    case EPDDisplay::ROTATE_180:
-        X = widthMemory - x - 1;
-        Y = heightMemory - y - 1;
+    case EPDDisplay::ROTATE_270: // X = y, Y = H - 1 - x
+        t.yStepX = 1;
+        t.originY = heightMemory - 1;
+        t.xStepY = -1;
         break;
-    case EPDDisplay::ROTATE_270:
-        X = y;
-        Y = heightMemory - x - 1;
+    default: // ROTATE_0: X = x, Y = y
+        t.xStepX = 1;
+        t.yStepY = 1;
         break;
-    default:
-        Debug("Invalid rotation mode\r\n");
-        return;
     }
+    // Points must be inside the logical width x height (what the other
+    // primitives clip to) and map into the buffer
+    bool swapped = (rotate == EPDDisplay::ROTATE_90 || rotate == EPDDisplay::ROTATE_270);
+    uint16_t rangeX = swapped ? heightMemory : widthMemory;
+    uint16_t rangeY = swapped ? widthMemory : heightMemory;
+    t.limitX = (width < rangeX) ? width : rangeX;
+    t.limitY = (height < rangeY) ? height : rangeY;
 
-    switch (mirror)
+    // Mirroring flips the buffer axis after rotation: X' = W - 1 - X
+    if (mirror == EPDDisplay::MIRROR_HORIZONTAL || mirror == EPDDisplay::MIRROR_ORIGIN)
     {
-    case EPDDisplay::MIRROR_NONE:
-        break;
-    case EPDDisplay::MIRROR_HORIZONTAL:
-        X = widthMemory - X - 1;
-        break;
-    case EPDDisplay::MIRROR_VERTICAL:
-        Y = heightMemory - Y - 1;
-        break;
-    case EPDDisplay::MIRROR_ORIGIN:
-        X = widthMemory - X - 1;
-        Y = heightMemory - Y - 1;
-        break;
-    default:
-        Debug("Invalid mirror mode\r\n");
-        return;
+        t.originX = widthMemory - 1 - t.originX;
+        t.xStepX = -t.xStepX;
+        t.yStepX = -t.yStepX;
     }
+    if (mirror == EPDDisplay::MIRROR_VERTICAL || mirror == EPDDisplay::MIRROR_ORIGIN)
+    {
+        t.originY = heightMemory - 1 - t.originY;
+        t.xStepY = -t.xStepY;
+        t.yStepY = -t.yStepY;
+    }
+    transform = t;
+}
 
-    if (X > widthMemory || Y > heightMemory)
+bool EPDDisplay::transformPoint(uint16_t x, uint16_t y, uint16_t *X, uint16_t *Y)
+{
+    if (x >= transform.limitX || y >= transform.limitY)
+    {
+        return false;
+    }
+    *X = transform.originX + x * transform.xStepX + y * transform.yStepX;
+    *Y = transform.originY + x * transform.xStepY + y * transform.yStepY;
+    return true;
+}
+
+void EPDDisplay::drawPixel(uint16_t x, uint16_t y, COLOR color)
+{
+    // One range check in user coordinates covers every rotation and mirror
+    if (x >= transform.limitX || y >= transform.limitY)
     {
         Debug("Exceeding display boundaries\r\n");
         return;
     }
+    uint16_t X = transform.originX + x * transform.xStepX + y * transform.yStepX;
+    uint16_t Y = transform.originY + x * transform.xStepY + y * transform.yStepY;
+
+    if (color == EPDDisplay::NULL_COLOR)
+    {
+        return; // Transparent — leave pixel unchanged
+    }
+
+    // Banded rendering: only the rows of the current band are in memory
+    // (rows above the band wrap around to large values)
+    uint16_t row = Y - bufferRowOffset;
+    if (row >= bufferRows)
+    {
+        return;
+    }
+
+    // Grow the dirty region (buffer coordinates) consumed by display()
+    if (X < dirty.xStart)
+        dirty.xStart = X;
+    if (X > dirty.xEnd)
+        dirty.xEnd = X;
+    if (Y < dirty.yStart)
+        dirty.yStart = Y;
+    if (Y > dirty.yEnd)
+        dirty.yEnd = Y;
 
     // Compute byte address and bit mask within that byte (MSB = left pixel)
-    uint32_t Addr = X / 8 + Y * widthByte;
+    uint32_t Addr = (X / 8 + (uint32_t)row * widthByte) * EPD_PLANE_STRIDE;
     uint8_t  bit  = 0x80 >> (X % 8);
 
     // Write the two buffer planes according to the color.
@@ -98,29 +149,53 @@ void EPDDisplay::drawPixel(uint16_t x, uint16_t y, COLOR color)
 
 void EPDDisplay::fillScreen(COLOR color)
 {
-    for (uint16_t Y = 0; Y < heightByte; Y++)
+    if (color == EPDDisplay::NULL_COLOR)
     {
-        for (uint16_t X = 0; X < widthByte; X++)
-        { // 8 pixel =  1 byte
-            uint32_t Addr = X + Y * widthByte;
-            switch (color)
-            {
-            case EPDDisplay::BLACK:
-                blackBuffer[Addr] = 0x00;
-                redBuffer[Addr] = 0xFF;
-                break;
-            case EPDDisplay::WHITE:
-                blackBuffer[Addr] = 0xFF;
-                redBuffer[Addr] = 0xFF;
-                break;
-            case EPDDisplay::RED:
-                blackBuffer[Addr] = 0xFF;
-                redBuffer[Addr] = 0x00;
-                break;
-            case EPDDisplay::NULL_COLOR:
-                break;
-            }
-        }
+        return;
+    }
+    markAllDirty();
+    EPDColorMask mask = epdColorMask(color);
+    fillPlanes(mask.black, mask.red);
+}
+
+void EPDDisplay::fillPlanes(uint8_t black, uint8_t red)
+{
+    uint32_t size = (uint32_t)bufferRows * widthByte;
+#if EPD_INTERLEAVED_PLANES
+    if (black == red)
+    {
+        memset(blackBuffer, black, 2 * size);
+        return;
+    }
+    for (uint32_t i = 0; i < 2 * size; i += 2)
+    {
+        blackBuffer[i] = black;
+        blackBuffer[i + 1] = red;
+    }
+#else
+    // Every byte of a plane holds the same value: one memset() per plane
+    memset(blackBuffer, black, size);
+    memset(redBuffer, red, size);
+#endif
+}
+
+void EPDDisplay::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, COLOR color)
+{
+    if (x >= width || y >= height)
+    {
+        Debug("fillRect Input exceeds the normal display range\r\n");
+        return;
+    }
+    if (color == EPDDisplay::NULL_COLOR || w == 0 || h == 0)
+    {
+        return;
+    }
+    int32_t x1 = (int32_t)x + w - 1;
+    int32_t y1 = (int32_t)y + h - 1;
+    EPDPixelWriter writer(this);
+    if (writer.begin(x, y, x1, y1))
+    {
+        writer.fill(x, y, x1, y1, epdColorMask(color));
     }
 }
 
@@ -130,6 +205,7 @@ void EPDDisplay::setRotation(uint8_t rotate)
         rotate == EPDDisplay::ROTATE_0 || rotate == EPDDisplay::ROTATE_90 || rotate == EPDDisplay::ROTATE_180 || rotate == EPDDisplay::ROTATE_270)
     {
         this->rotate = rotate;
+        updateTransform();
     }
     else
     {
@@ -143,6 +219,7 @@ void EPDDisplay::setMirror(uint8_t mirror)
         mirror == EPDDisplay::MIRROR_VERTICAL || mirror == EPDDisplay::MIRROR_ORIGIN)
     {
         this->mirror = mirror;
+        updateTransform();
     }
     else
     {
@@ -162,22 +239,26 @@ void EPDDisplay::drawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t hei
         Debug("Exceeding display boundaries\r\n");
         return;
     }
-    uint16_t X, Y;
-    for (Y = 0; Y < height; Y++)
+
+    // Clip the bitmap once; only its visible part is read and written
+    EPDPixelWriter writer(this);
+    if (width == 0 || height == 0 || !writer.begin(x, y, x + width - 1, y + height - 1))
     {
-        for (X = 0; X < width; X++)
-        {
-            // Check if we're still within display bounds
-            if ((x + X) >= this->width || (y + Y) >= this->height)
-                continue;
+        return;
+    }
+    bool drawActive = (active_color != EPDDisplay::NULL_COLOR);
+    bool drawInactive = (inactive_color != EPDDisplay::NULL_COLOR);
+    EPDColorMask active = epdColorMask(active_color);
+    EPDColorMask inactive = epdColorMask(inactive_color);
 
-            if (bitmap[(X + Y * width) / 8] & (0x80 >> (X % 8)))
-            {
-                drawPixel(x + X, y + Y, active_color);
-            }
-            else
+    for (int32_t Y = writer.top() - y; Y <= writer.bottom() - y; Y++)
+    {
+        for (int32_t X = writer.left() - x; X <= writer.right() - x; X++)
+        {
+            bool set = (bitmap[(X + Y * (uint32_t)width) / 8] & (0x80 >> (X % 8))) != 0;
+            if (set ? drawActive : drawInactive)
             {
-                drawPixel(x + X, y + Y, inactive_color);
+                writer.put(x + X, y + Y, set ? active : inactive);
             }
         }
     }
@@ -20,10 +20,28 @@
  *
  * drawPolygon — outline via drawLine between consecutive vertices;
  *   fill via scanline even-odd rule (ray casting along horizontal scanlines).
+ *
+ * Fills clip the shape's bounding box once and write every scanline as a
+ * byte-wise span (EPDPixelWriter::fill(), the same path as drawHSpan()),
+ * grown by line_width - 1 on every side. Spans are clipped at the display
+ * edges rather than dropped.
  */
-#include "EPDDisplay.h"
+#include "EPDPixelWriter.h"
 #include <cmath>
 
+// One row of a filled shape from xa to xb (either order), grown by
+// line_width - 1 on every side like the drawLine() rows it replaces
+static inline void fillSpan(EPDPixelWriter &writer, EPDColorMask mask, int32_t xa, int32_t xb, int32_t y, int32_t grow)
+{
+  if (xa > xb)
+  {
+    int32_t temp = xa;
+    xa = xb;
+    xb = temp;
+  }
+  writer.fill(xa - grow, y - grow, xb + grow, y + grow, mask);
+}
+
 void EPDDisplay::drawRoundedRectangle(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend, uint16_t radius, COLOR color, uint8_t line_width, LINE_STYLE line_style, DRAW_FILL draw_fill)
 {
   if (Xstart > width || Ystart > height ||
@@ -35,9 +53,17 @@ void EPDDisplay::drawRoundedRectangle(uint16_t Xstart, uint16_t Ystart, uint16_t
 
   if (draw_fill == DRAW_FULL)
   {
-    // Fill the horizontal middle band (straight sides)
-    for (uint16_t y = Ystart + radius; y <= Yend - radius; y++)
-      drawLine(Xstart, y, Xend, y, color, 1, LINE_SOLID);
+    if (color == EPDDisplay::NULL_COLOR)
+      return;
+    EPDPixelWriter writer(this);
+    EPDColorMask mask = epdColorMask(color);
+    if (!writer.begin(Xstart < Xend ? Xstart : Xend, Ystart < Yend ? Ystart : Yend,
+                      Xstart < Xend ? Xend : Xstart, Ystart < Yend ? Yend : Ystart))
+      return;
+
+    // Fill the horizontal middle band (straight sides) as one box
+    writer.fill(Xstart < Xend ? Xstart : Xend, Ystart + radius,
+                Xstart < Xend ? Xend : Xstart, (int32_t)Yend - radius, mask);
 
     // Fill the top and bottom curved bands using circle scanline logic.
     // We reuse the Bresenham midpoint circle to find the horizontal extents.
@@ -46,15 +72,11 @@ void EPDDisplay::drawRoundedRectangle(uint16_t Xstart, uint16_t Ystart, uint16_t
     while (XCurrent <= YCurrent)
     {
       // Top arc: row = Ystart + radius - YCurrent .. Ystart + radius - XCurrent
-      drawLine(Xstart + radius - XCurrent, Ystart + radius - YCurrent,
-               Xend - radius + XCurrent, Ystart + radius - YCurrent, color, 1, LINE_SOLID);
-      drawLine(Xstart + radius - YCurrent, Ystart + radius - XCurrent,
-               Xend - radius + YCurrent, Ystart + radius - XCurrent, color, 1, LINE_SOLID);
+      fillSpan(writer, mask, Xstart + radius - XCurrent, Xend - radius + XCurrent, Ystart + radius - YCurrent, 0);
+      fillSpan(writer, mask, Xstart + radius - YCurrent, Xend - radius + YCurrent, Ystart + radius - XCurrent, 0);
       // Bottom arc
-      drawLine(Xstart + radius - XCurrent, Yend - radius + YCurrent,
-               Xend - radius + XCurrent, Yend - radius + YCurrent, color, 1, LINE_SOLID);
-      drawLine(Xstart + radius - YCurrent, Yend - radius + XCurrent,
-               Xend - radius + YCurrent, Yend - radius + XCurrent, color, 1, LINE_SOLID);
+      fillSpan(writer, mask, Xstart + radius - XCurrent, Xend - radius + XCurrent, (int32_t)Yend - radius + YCurrent, 0);
+      fillSpan(writer, mask, Xstart + radius - YCurrent, Xend - radius + YCurrent, (int32_t)Yend - radius + XCurrent, 0);
 
       if (Esp < 0)
         Esp += 4 * XCurrent + 6;
@@ -150,6 +172,18 @@ void EPDDisplay::drawTriangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2
 
   if (draw_fill)
   {
+    if (color == EPDDisplay::NULL_COLOR || line_width == 0)
+      return;
+    int32_t grow = (int32_t)line_width - 1;
+    int32_t xMin = x1 < x2 ? (x1 < x3 ? x1 : x3) : (x2 < x3 ? x2 : x3);
+    int32_t xMax = x1 > x2 ? (x1 > x3 ? x1 : x3) : (x2 > x3 ? x2 : x3);
+    int32_t yMin = y1 < y2 ? (y1 < y3 ? y1 : y3) : (y2 < y3 ? y2 : y3);
+    int32_t yMax = y1 > y2 ? (y1 > y3 ? y1 : y3) : (y2 > y3 ? y2 : y3);
+    EPDPixelWriter writer(this);
+    EPDColorMask mask = epdColorMask(color);
+    if (!writer.begin(xMin - grow, yMin - grow, xMax + grow, yMax + grow))
+      return;
+
     if (y1 > y2)
     {
       uint16_t temp = x1;
@@ -184,13 +218,7 @@ void EPDDisplay::drawTriangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2
       {
         int32_t xa = (int32_t)x1 + ((int32_t)(x2 - x1) * (y - y1)) / (y2 - y1);
         int32_t xb = (int32_t)x1 + ((int32_t)(x3 - x1) * (y - y1)) / (y3 - y1);
-        if (xa > xb)
-        {
-          int32_t temp = xa;
-          xa = xb;
-          xb = temp;
-        }
-        drawLine((uint16_t)xa, y, (uint16_t)xb, y, color, line_width, LINE_SOLID);
+        fillSpan(writer, mask, xa, xb, y, grow);
       }
     }
 
@@ -200,13 +228,7 @@ void EPDDisplay::drawTriangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2
       {
         int32_t xa = (int32_t)x2 + ((int32_t)(x3 - x2) * (y - y2)) / (y3 - y2);
         int32_t xb = (int32_t)x1 + ((int32_t)(x3 - x1) * (y - y1)) / (y3 - y1);
-        if (xa > xb)
-        {
-          int32_t temp = xa;
-          xa = xb;
-          xb = temp;
-        }
-        drawLine((uint16_t)xa, y, (uint16_t)xb, y, color, line_width, LINE_SOLID);
+        fillSpan(writer, mask, xa, xb, y, grow);
       }
     }
   }
@@ -236,10 +258,20 @@ void EPDDisplay::drawEllipse(uint16_t x_center, uint16_t y_center, uint16_t radi
 
   if (draw_fill)
   {
+    if (color == EPDDisplay::NULL_COLOR || line_width == 0)
+      return;
+    int32_t grow = (int32_t)line_width - 1;
+    EPDPixelWriter writer(this);
+    EPDColorMask mask = epdColorMask(color);
+    // One extra column each side: the second region can step x to radius_x + 1
+    if (!writer.begin(x_center - radius_x - 1 - grow, y_center - radius_y - grow,
+                      x_center + radius_x + 1 + grow, y_center + radius_y + grow))
+      return;
+
     while (ry2 * x <= rx2 * y)
     {
-      drawLine(x_center - x, y_center - y, x_center + x, y_center - y, color, line_width, LINE_SOLID);
-      drawLine(x_center - x, y_center + y, x_center + x, y_center + y, color, line_width, LINE_SOLID);
+      fillSpan(writer, mask, x_center - x, x_center + x, y_center - y, grow);
+      fillSpan(writer, mask, x_center - x, x_center + x, y_center + y, grow);
 
       if (s >= 0)
       {
@@ -253,8 +285,8 @@ void EPDDisplay::drawEllipse(uint16_t x_center, uint16_t y_center, uint16_t radi
     s = 2 * rx2 + ry2 * (1 - 2 * radius_x);
     while (y >= 0)
     {
-      drawLine(x_center - x, y_center - y, x_center + x, y_center - y, color, line_width, LINE_SOLID);
-      drawLine(x_center - x, y_center + y, x_center + x, y_center + y, color, line_width, LINE_SOLID);
+      fillSpan(writer, mask, x_center - x, x_center + x, y_center - y, grow);
+      fillSpan(writer, mask, x_center - x, x_center + x, y_center + y, grow);
 
       if (s <= 0)
       {
@@ -267,6 +299,16 @@ void EPDDisplay::drawEllipse(uint16_t x_center, uint16_t y_center, uint16_t radi
   }
   else
   {
+    // Thin outline: clip the ellipse's box once, write through the unchecked path.
+    // The second region can step x to radius_x + 1, hence the extra column each side.
+    if (color == EPDDisplay::NULL_COLOR)
+      return;
+    EPDPixelWriter writer(this);
+    EPDColorMask mask = epdColorMask(color);
+    if (line_width <= 1 &&
+        !writer.begin(x_center - radius_x - 1, y_center - radius_y, x_center + radius_x + 1, y_center + radius_y))
+      return;
+
     while (ry2 * x <= rx2 * y)
     {
       if (line_width > 1)
@@ -278,10 +320,10 @@ void EPDDisplay::drawEllipse(uint16_t x_center, uint16_t y_center, uint16_t radi
       }
       else
       {
-        drawPixel(x_center + x, y_center + y, color);
-        drawPixel(x_center - x, y_center + y, color);
-        drawPixel(x_center + x, y_center - y, color);
-        drawPixel(x_center - x, y_center - y, color);
+        writer.putClipped(x_center + x, y_center + y, mask);
+        writer.putClipped(x_center - x, y_center + y, mask);
+        writer.putClipped(x_center + x, y_center - y, mask);
+        writer.putClipped(x_center - x, y_center - y, mask);
       }
 
       if (s >= 0)
@@ -305,10 +347,10 @@ void EPDDisplay::drawEllipse(uint16_t x_center, uint16_t y_center, uint16_t radi
       }
       else
       {
-        drawPixel(x_center + x, y_center + y, color);
-        drawPixel(x_center - x, y_center + y, color);
-        drawPixel(x_center + x, y_center - y, color);
-        drawPixel(x_center - x, y_center - y, color);
+        writer.putClipped(x_center + x, y_center + y, mask);
+        writer.putClipped(x_center - x, y_center + y, mask);
+        writer.putClipped(x_center + x, y_center - y, mask);
+        writer.putClipped(x_center - x, y_center - y, mask);
       }
 
       if (s <= 0)
@@ -332,16 +374,29 @@ void EPDDisplay::drawPolygon(const uint16_t *points_x, const uint16_t *points_y,
 
   if (draw_fill)
   {
+    if (color == EPDDisplay::NULL_COLOR || line_width == 0)
+      return;
+    uint16_t min_x = points_x[0], max_x = points_x[0];
     uint16_t min_y = points_y[0], max_y = points_y[0];
 
     for (uint8_t i = 1; i < num_points; i++)
     {
+      if (points_x[i] < min_x)
+        min_x = points_x[i];
+      if (points_x[i] > max_x)
+        max_x = points_x[i];
       if (points_y[i] < min_y)
         min_y = points_y[i];
       if (points_y[i] > max_y)
         max_y = points_y[i];
     }
 
+    int32_t grow = (int32_t)line_width - 1;
+    EPDPixelWriter writer(this);
+    EPDColorMask mask = epdColorMask(color);
+    if (!writer.begin(min_x - grow, min_y - grow, max_x + grow, max_y + grow))
+      return;
+
     // Scanline even-odd fill:
     // For each horizontal scanline Y, find all edges that cross it, compute
     // their X intersections, sort them, then fill pairs (x0→x1, x2→x3, ...).
@@ -387,7 +442,7 @@ void EPDDisplay::drawPolygon(const uint16_t *points_x, const uint16_t *points_y,
       {
         if (i + 1 < intersection_count)
         {
-          drawLine((uint16_t)intersections[i], y, (uint16_t)intersections[i + 1], y, color, line_width, LINE_SOLID);
+          fillSpan(writer, mask, intersections[i], intersections[i + 1], y, grow);
         }
       }
     }
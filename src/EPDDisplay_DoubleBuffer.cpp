@@ -0,0 +1,135 @@
+/**
+ * @file EPDDisplay_DoubleBuffer.cpp
+ * @brief Render-while-refreshing: optional front buffers and commit().
+ *
+ * With double buffering enabled there are two pairs of planes:
+ *   - draw buffers (blackBuffer / redBuffer): every drawing call writes here
+ *   - front buffers (frontBlack / frontRed): the last committed frame
+ *
+ * commit() swaps the two pairs, so the frame just drawn becomes the front
+ * frame without copying, then starts an asynchronous refresh from it. When a
+ * refresh is still running, the frame is queued instead and isRefreshing()
+ * starts it as soon as the panel is idle; the application keeps drawing
+ * frame N+1 in the meantime.
+ *
+ * Copy-on-swap: after the swap the draw buffers hold an older frame, so by
+ * default the committed frame is copied back into them and drawing continues
+ * incrementally. commit(false) skips the 116 KB copy for applications that
+ * redraw every frame from scratch.
+ *
+ * The front pair follows the allocation policy and the plane layout (see
+ * EPDDisplay_Memory.cpp); swapping pointers works for interleaved planes too.
+ *
+ * Dirty tracking: frontDirty accumulates the dirty rectangle of every frame
+ * committed since the last front upload, so a replaced queued frame still
+ * uploads everything that changed.
+ */
+#include "EPDDisplay.h"
+
+// Copy a plane pair; interleaved planes are one block of twice the size
+static void copyPlanes(uint8_t *black, uint8_t *red, const uint8_t *srcBlack, const uint8_t *srcRed, uint32_t size)
+{
+#if EPD_INTERLEAVED_PLANES
+    (void)red;
+    (void)srcRed;
+    memcpy(black, srcBlack, 2 * size);
+#else
+    memcpy(black, srcBlack, size);
+    memcpy(red, srcRed, size);
+#endif
+}
+
+bool EPDDisplay::enableDoubleBuffer()
+{
+    if (!isInitialized)
+    {
+        Debug("EPD not initialized\r\n");
+        return false;
+    }
+    if (isBanded())
+    {
+        return false;
+    }
+    if (frontBlack != NULL)
+    {
+        return true;
+    }
+
+    uint32_t imageSize = (uint32_t)widthByte * heightByte;
+    // The front pair is only read by the upload: same placement rules as the
+    // draw buffers (caller-provided draw buffers fall back to ALLOC_AUTO)
+    ALLOC_POLICY policy = (allocPolicy == EPDDisplay::ALLOC_CALLER) ? EPDDisplay::ALLOC_AUTO : allocPolicy;
+    if (!allocPlanePair(&frontBlack, &frontRed, imageSize, policy))
+    {
+        Debug("Failed to allocate memory for front buffers\r\n");
+        return false;
+    }
+
+    copyPlanes(frontBlack, frontRed, blackBuffer, redBuffer, imageSize);
+    emptyRect(&frontDirty);
+    return true;
+}
+
+void EPDDisplay::disableDoubleBuffer()
+{
+    waitRefresh(); // Also sends a queued commit
+    freeBackBuffers();
+}
+
+bool EPDDisplay::isDoubleBuffered()
+{
+    return frontBlack != NULL;
+}
+
+void EPDDisplay::freeBackBuffers()
+{
+    freePlanePair(frontBlack, frontRed);
+    frontBlack = NULL;
+    frontRed = NULL;
+    commitPending = false;
+}
+
+bool EPDDisplay::commit(bool preserve)
+{
+    if (frontBlack == NULL)
+    {
+        return displayAsync();
+    }
+    if (!checkDisplayReady())
+    {
+        return false;
+    }
+
+    // Checked before the swap: this may itself start an earlier queued frame
+    bool busy = isRefreshing();
+
+    uint8_t *swap = frontBlack;
+    frontBlack = blackBuffer;
+    blackBuffer = swap;
+    swap = frontRed;
+    frontRed = redBuffer;
+    redBuffer = swap;
+
+    unionRect(&frontDirty, &dirty);
+    if (preserve)
+    {
+        copyPlanes(blackBuffer, redBuffer, frontBlack, frontRed, (uint32_t)widthByte * heightByte);
+        clearDirty();
+    }
+    else
+    {
+        // The draw buffers now hold an older frame: any part of it may differ
+        markAllDirty();
+    }
+
+    if (busy)
+    {
+        commitPending = true;
+        Debug("commit queued\r\n");
+        return true;
+    }
+
+    StartRefresh(true);
+    Debug("commit\r\n");
+    return true;
+}
@@ -3,16 +3,21 @@
  * @brief Hardware-level operations: initialization, SPI communication,
  *        display refresh, clear, sleep, and wakeup.
  *
- * SPI is bit-banged (software SPI): each bit is clocked manually via GPIO.
- * This avoids conflicts with the ESP32 hardware SPI peripheral and lets any
- * GPIO be used for any signal. The trade-off is slower bit rate (~1 MHz
- * effective), but the bottleneck is always the display's own processing time
- * (~15–20 s for a full tricolor refresh), not the SPI transfer speed.
+ * All bytes go through an EPDTransport (see EPDTransport.h): bit-banged SPI
+ * on any GPIOs by default, or the ESP32 VSPI/HSPI peripheral with DMA. The
+ * framebuffer planes are streamed as data bursts (BeginData / SendDataSpan /
+ * EndData): DC and CS are asserted once per plane instead of once per byte,
+ * and the DMA backend can move the whole plane without per-byte CPU work.
+ * BUSY, RST and delays go through the transport as well.
  *
  * Buffer encoding convention (stored internally):
  *   - blackBuffer  bit=1 → white or red pixel;  bit=0 → black pixel
  *   - redBuffer    bit=1 → white or black pixel; bit=0 → red pixel
  *
+ * With EPD_INTERLEAVED_PLANES both planes share one buffer (black byte, red
+ * byte, black byte, ...); each plane is picked out while streaming
+ * (EPDTransport::writeDataStrided()).
+ *
  * When sending to the display:
  *   - Command 0x24 (BW plane): blackBuffer is sent as-is
  *   - Command 0x26 (Red plane): ~redBuffer is sent (bitwise NOT), because
@@ -20,120 +25,194 @@
  */
 #include "EPDDisplay.h"
 
+// Bytes spent reprogramming the RAM window for a new run of rows
+// (0x44 + 4, 0x45 + 4, 0x4E + 2, 0x4F + 2, 0x24/0x26)
+#define EPD_WINDOW_SETUP_BYTES 17
+
+// RAM Y address of the top display row. The gate count is set to 0x2AF + 1
+// (0x01 below) and Y counts down, so buffer row j lives at RAM row 687 - j.
+#define EPD_RAM_Y_TOP 0x02AF
+
+// Controller boot time after the RST pulse before BUSY is meaningful
+#define EPD_RESET_BOOT_MS 10
+
+// Init command table entries: command, flags | data length, data bytes
+#define EPD_INIT_WAIT 0x80     // Wait for the BUSY edge after this command
+#define EPD_INIT_RAM 0x40      // Overwrites RAM: skipped when RAM is kept
+#define EPD_INIT_LENGTH 0x3F
+
+// Controller init sequence, sent back to back by hwInit(); only the entries
+// marked EPD_INIT_WAIT block, and only until BUSY releases.
+static constexpr uint8_t EPD_INIT_TABLE[] = {
+    // Software Reset (SWRESET): restores all registers to defaults
+    0x12, EPD_INIT_WAIT | 0,
+    // Auto Write Red / BW RAM: pre-fill both planes with all 1s (pattern 0xF7)
+    // so RAM is in a defined state before the first real frame is sent
+    0x46, EPD_INIT_WAIT | EPD_INIT_RAM | 1, 0xF7,
+    0x47, EPD_INIT_WAIT | EPD_INIT_RAM | 1, 0xF7,
+    // Booster Soft Start: charge pump phases A/B/C/D
+    0x0C, 5, 0xAE, 0xC7, 0xC3, 0xC0, 0x40,
+    // Driver Output Control: MUX = 0x02AF → 688 gate lines, the panel's 528
+    // rows are RAM rows 687 down to 160; gate scanning top-to-bottom
+    0x01, 3, 0xAF, 0x02, 0x01,
+    // Data Entry Mode: X increment, Y decrement
+    0x11, 1, 0x01,
+    // RAM X window: columns 0x0000 to 0x036F (0–879)
+    0x44, 4, 0x00, 0x00, 0x6F, 0x03,
+    // RAM Y window: rows 0x02AF (EPD_RAM_Y_TOP) down to 0x0000
+    0x45, 4, 0xAF, 0x02, 0x00, 0x00,
+    // Border Waveform Control: border pixel = white (LUT1)
+    0x3C, 1, 0x01,
+    // Temperature sensor: internal
+    0x18, 1, 0x80,
+    // Load temperature + waveform LUT, then activate
+    0x22, 1, 0xB1,
+    0x20, EPD_INIT_WAIT | 0,
+    // RAM address counters: top-left of the window (X = 0, Y = 687)
+    0x4E, 2, 0x00, 0x00,
+    0x4F, 2, 0xAF, 0x02,
+};
+
 // ── Private: sends the full controller init sequence ─────────────────────────
 // Separated from initialize() so that wakeUp() can re-apply all settings
 // after a hardware reset without re-allocating buffers.
-void EPDDisplay::hwInit()
-{
-    SendCommand(0x12); // Software Reset (SWRESET) — restores all registers to defaults
-    ReadBusy();        // Wait until the controller finishes its internal reset
-
-    // Auto Write RAM: pre-fills both BW and Red RAM with 0xF7 (all-white pattern)
-    // This ensures a clean state before the first real frame is sent.
-    SendCommand(0x46); // Auto Write BW RAM
-    SendData(0xF7);
-    ReadBusy();
-
-    SendCommand(0x47); // Auto Write Red RAM
-    SendData(0xF7);
-    ReadBusy();
-
-    // Booster Soft Start (0x0C): configures the charge pump phases A/B/C/D.
-    SendCommand(0x0C);
-    SendData(0xAE); // Phase A
-    SendData(0xC7); // Phase B
-    SendData(0xC3); // Phase C
-    SendData(0xC0); // Phase D
-    SendData(0x40);
-
-    // Driver Output Control (0x01): sets MUX = 0x02AF → 528 gate lines (0-indexed 0..527)
-    SendCommand(0x01);
-    SendData(0xAF); // MUX low byte
-    SendData(0x02); // MUX high byte
-    SendData(0x01); // Gate scanning: top-to-bottom
-
-    // Data Entry Mode (0x11): X-increment then Y-increment (left-to-right, top-to-bottom)
-    SendCommand(0x11);
-    SendData(0x01);
-
-    // Set RAM X address window: columns 0x0000 to 0x036F (0–879)
-    SendCommand(0x44);
-    SendData(0x00); // X start low byte
-    SendData(0x00); // X start high byte
-    SendData(0x6F); // X end low byte  (0x036F = 879)
-    SendData(0x03); // X end high byte
+void EPDDisplay::hwInit(bool keepRam)
+{
+    const uint8_t *entry = EPD_INIT_TABLE;
+    const uint8_t *end = EPD_INIT_TABLE + sizeof(EPD_INIT_TABLE);
+    while (entry < end)
+    {
+        uint8_t command = entry[0];
+        uint8_t flags = entry[1];
+        uint8_t length = flags & EPD_INIT_LENGTH;
+        entry += 2;
 
-    // Set RAM Y address window: rows 0x02AF down to 0x0000 (527–0)
-    SendCommand(0x45);
-    SendData(0xAF); // Y start low byte  (0x02AF = 527)
-    SendData(0x02); // Y start high byte
-    SendData(0x00); // Y end low byte    (0)
-    SendData(0x00); // Y end high byte
+        if (keepRam && (flags & EPD_INIT_RAM))
+        {
+            entry += length;
+            continue;
+        }
+        SendCommand(command);
+        if (length > 0)
+        {
+            // One burst per command: DC and CS stay asserted over its data
+            BeginData();
+            SendDataSpan(entry, length, false);
+            EndData();
+            entry += length;
+        }
+        if (flags & EPD_INIT_WAIT)
+        {
+            ReadBusy(initGuardMs);
+        }
+    }
 
-    // Border Waveform Control: border pixel = white (LUT1)
-    SendCommand(0x3C);
-    SendData(0x01);
+    // Controller RAM now holds the auto-write pattern, not our framebuffers
+    if (!keepRam)
+    {
+        ramSynced = false;
+        markAllDirty();
+        invalidateRowHashes();
+    }
 
-    // Temperature sensor: use internal sensor
-    SendCommand(0x18);
-    SendData(0x80);
-    // Load temperature + waveform LUT, then activate
-    SendCommand(0x22);
-    SendData(0xB1);
-    SendCommand(0x20);
-    ReadBusy(); // Wait for LUT load to complete
+    // The LUT register holds the OTP waveform loaded above (0xB1)
+    loadedWaveform = (waveforms[EPDDisplay::REFRESH_FULL_TRICOLOR] == &WAVEFORM_FULL_TRICOLOR) ? &WAVEFORM_FULL_TRICOLOR : NULL;
+}
 
-    // Set initial RAM address counters to top-left of window
-    SendCommand(0x4E); // X address counter = 0
-    SendData(0x00);
-    SendData(0x00);
-    SendCommand(0x4F); // Y address counter = 527 (top of display)
-    SendData(0xAF);
-    SendData(0x02);
+void EPDDisplay::startController(bool keepRam)
+{
+    uint32_t start = transport->nowUs();
+    reset();
+    uint32_t resetEnd = transport->nowUs();
+
+    // ReadBusy() accumulates into frameTiming; no frame is open here
+    memset(&frameTiming, 0, sizeof(frameTiming));
+    hwInit(keepRam);
+    resumeFrame = keepRam;
+    uint32_t now = transport->nowUs();
+
+    startupTiming.resetUs = resetEnd - start;
+    startupTiming.busyUs = frameTiming.busyUs;
+    startupTiming.settleUs = frameTiming.settleUs;
+    uint32_t init = now - resetEnd;
+    uint32_t waits = frameTiming.busyUs + frameTiming.settleUs;
+    startupTiming.uploadUs = (init > waits) ? init - waits : 0;
+    startupTiming.totalUs = now - start;
+    memset(&frameTiming, 0, sizeof(frameTiming));
+    lastFrameEndUs = now;
+
+    if (startupTimingCallback != NULL)
+    {
+        startupTimingCallback(this, &startupTiming, startupTimingCallbackArg);
+    }
 }
 
 bool EPDDisplay::initialize()
+{
+    return initializeWithRows(heightByte);
+}
+
+// Shared by initialize() (whole frame) and initializeBanded() (one band)
+bool EPDDisplay::initializeWithRows(uint16_t rows)
 {
     // Reset transform state on every call
     rotate = EPDDisplay::ROTATE_0;
     mirror = EPDDisplay::MIRROR_NONE;
+    updateTransform();
 
     if (isInitialized)
     {
+        if (rows != bufferRows)
+        {
+            Debug("Already initialized with a different buffer height\r\n");
+        }
         return true;
     }
 
-    // Allocate framebuffers — use uint32_t to avoid uint8_t × uint16_t truncation
-    uint32_t imageSize = (uint32_t)widthByte * heightByte;
+    // Start the SPI link first: the framebuffer placement depends on it. A
+    // hardware SPI backend that cannot be started (non-ESP32 target, bus
+    // already claimed, no DMA memory) is replaced by the bit-banged backend
+    // on the same pins.
+    if (!transport->begin())
+    {
+        if (!ownsTransport)
+        {
+            Debug("Failed to start transport\r\n");
+            return false;
+        }
+        Debug("Hardware SPI unavailable, falling back to bit-banged SPI\r\n");
+        delete transport;
+        transport = new EPDBitBangTransport(m_DC_pin, m_CS_pin, m_CLK_pin, m_DIN_pin);
+        transport->begin();
+    }
 
-    blackBuffer = (uint8_t *)malloc(imageSize);
-    if (blackBuffer == NULL)
+    // BUSY / RST: displays built from a bare transport leave them to it
+    if (m_BUSY_pin >= 0 || m_RST_pin >= 0)
     {
-        Debug("Failed to allocate memory for black buffer\r\n");
-        return false;
+        transport->setControlPins(m_BUSY_pin, m_RST_pin);
     }
 
-    redBuffer = (uint8_t *)malloc(imageSize);
-    if (redBuffer == NULL)
+    // Allocate framebuffers — use uint32_t to avoid uint8_t × uint16_t truncation
+    if (!allocateFramebuffers((uint32_t)widthByte * rows))
     {
-        free(blackBuffer);
-        blackBuffer = NULL;
-        Debug("Failed to allocate memory for red buffer\r\n");
         return false;
     }
 
-    // Configure GPIO pins
-    pinMode(m_BUSY_pin, INPUT);
-    pinMode(m_RST_pin, OUTPUT);
-    pinMode(m_DC_pin, OUTPUT);
-    pinMode(m_CLK_pin, OUTPUT);
-    pinMode(m_DIN_pin, OUTPUT);
-    pinMode(m_CS_pin, OUTPUT);
-    digitalWrite(m_CS_pin, HIGH);
-    digitalWrite(m_CLK_pin, LOW);
+    // Hashes of the rows last sent to controller RAM (one table per plane).
+    // Optional: without them every dirty row is uploaded.
+    rowHash = (uint32_t *)malloc(2 * (uint32_t)heightByte * sizeof(uint32_t));
+    if (rowHash == NULL)
+    {
+        Debug("Failed to allocate row hash table, unchanged rows will be resent\r\n");
+    }
+    invalidateRowHashes();
 
-    reset();
-    hwInit();
+    bufferRowOffset = 0;
+    bufferRows = rows;
+
+    // Resuming from MCU deep sleep: controller RAM still holds the frame
+    // the saved fingerprint describes, so the auto write must not wipe it
+    startController(loadFingerprint());
 
     isInitialized = true;
     isSleep = false;
@@ -142,11 +221,10 @@ bool EPDDisplay::initialize()
 
 void EPDDisplay::reset()
 {
-    digitalWrite(m_RST_pin, 0);
-    delay(2);
-    digitalWrite(m_RST_pin, 1);
+    // Only the boot time is fixed; the rest is the controller's own BUSY
+    transport->reset(2, EPD_RESET_BOOT_MS);
+    ReadBusy(initGuardMs);
     isSleep = false;
-    delay(200);
 }
 
 void EPDDisplay::clear()
@@ -155,18 +233,22 @@ void EPDDisplay::clear()
     {
         return;
     }
+    waitRefresh();
+    beginFrame();
 
-    uint32_t imageSize = (uint32_t)widthByte * heightByte;
-    memset(blackBuffer, 0xFF, imageSize);
-    memset(redBuffer, 0xFF, imageSize);
+    fillPlanes(0xFF, 0xFF);
 
     ClearRed();
     ClearBlack();
-    SendCommand(0x22);
-    SendData(0xC7);
-    SendCommand(0x20);
-    delay(200);
-    ReadBusy();
+    // Controller RAM and framebuffers are both all-white now
+    ramSynced = true;
+    clearDirty();
+    setRowHashesWhite();
+    LoadWaveform(EPDDisplay::REFRESH_FULL_TRICOLOR);
+    TriggerRefresh();
+    Settle(200);
+    ReadBusy(EPD_BUSY_SETTLE_MS, lightSleep);
+    endFrame();
     Debug("clear EPD\r\n");
 }
 
@@ -176,49 +258,130 @@ void EPDDisplay::display()
     {
         return;
     }
+    if (isBanded())
+    {
+        return;
+    }
+    waitRefresh(); // Let an in-flight displayAsync() finish first
+    beginFrame();
+
+    bool resumed = resumeFrame;
+    resumeFrame = false;
+    uint32_t written = uploadStats.bytesSent + uploadStats.autoWrites;
+    bool redChanged = UploadFrame();
+    if (resumed && uploadStats.bytesSent + uploadStats.autoWrites == written)
+    {
+        // RAM and panel already show this frame since before the sleep
+        uploadStats.refreshesSkipped++;
+        endFrame();
+        Debug("display: unchanged since sleep, refresh skipped\r\n");
+        return;
+    }
+    LoadWaveform(redChanged ? EPDDisplay::REFRESH_FULL_TRICOLOR : refreshMode);
+    TriggerRefresh();
+    ReadBusy(EPD_BUSY_SETTLE_MS, lightSleep); // Block until the panel refresh is complete
+    endFrame();
+    Debug("display\r\n");
+}
 
-    uint32_t i, j;
-
-    // ── Send Black/White plane (command 0x24) ──────────────────────────────
-    // Reset the Y address counter to start from the top row (row 527)
-    SendCommand(0x4F);
-    SendData(0xAF);
-    SendData(0x02);
-    SendCommand(0x24); // Write to BW RAM
-    // Send all 110 × 528 = 58,080 bytes of the black buffer.
-    // blackBuffer encoding: bit=1 → white pixel, bit=0 → black pixel (controller native).
-    for (j = 0; j < heightByte; j++)
+void EPDDisplay::displayRegion(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    if (!checkDisplayReady())
     {
-        for (i = 0; i < widthByte; i++)
-        {
-            SendData(blackBuffer[i + j * widthByte]);
-        }
+        return;
+    }
+    if (w == 0 || h == 0)
+    {
+        Debug("displayRegion: empty region\r\n");
+        return;
     }
-    ReadBusy(); // Wait for BW RAM write to complete
+    if (isBanded())
+    {
+        return;
+    }
+    waitRefresh();
 
-    // ── Send Red plane (command 0x26) ──────────────────────────────────────
-    SendCommand(0x4F); // Reset Y address counter again
-    SendData(0xAF);
-    SendData(0x02);
-    SendCommand(0x26); // Write to Red RAM
-    // redBuffer encoding: bit=0 → red pixel, bit=1 → no red.
-    // The controller expects bit=1 for "red active", so we invert with ~.
-    for (j = 0; j < heightByte; j++)
+    // Clip to the display, then map two opposite corners to buffer
+    // coordinates. Rotation and mirroring keep rectangles axis-aligned, so
+    // the bounding box of the mapped corners is the region in the buffer.
+    if (x >= width || y >= height)
     {
-        for (i = 0; i < widthByte; i++)
+        Debug("displayRegion: region outside the display\r\n");
+        return;
+    }
+    uint16_t x1 = ((uint32_t)x + w > width) ? width - 1 : x + w - 1;
+    uint16_t y1 = ((uint32_t)y + h > height) ? height - 1 : y + h - 1;
+    uint16_t Xa, Ya, Xb, Yb;
+    if (!transformPoint(x, y, &Xa, &Ya) || !transformPoint(x1, y1, &Xb, &Yb))
+    {
+        Debug("displayRegion: region outside the display\r\n");
+        return;
+    }
+    uint16_t XStart = Xa < Xb ? Xa : Xb;
+    uint16_t XEnd = Xa < Xb ? Xb : Xa;
+    uint16_t YStart = Ya < Yb ? Ya : Yb;
+    uint16_t YEnd = Ya < Yb ? Yb : Ya;
+
+    beginFrame();
+    bool redChanged;
+    if (!ramSynced)
+    {
+        // Controller RAM outside the region is not our frame: send everything
+        redChanged = UploadWindow(blackBuffer, redBuffer, 0, widthByte - 1, 0, heightByte - 1);
+        ramSynced = true;
+        clearDirty();
+    }
+    else
+    {
+        // Rows of the region hold the whole buffer row afterwards only if no
+        // pending drawing lies outside the region's byte columns
+        bool rowsComplete = dirty.xStart > dirty.xEnd ||
+                            (dirty.xStart / 8 >= XStart / 8 && dirty.xEnd / 8 <= XEnd / 8);
+        redChanged = UploadWindow(blackBuffer, redBuffer, XStart / 8, XEnd / 8, YStart, YEnd, rowsComplete);
+        // The region may not cover everything drawn since the last upload
+        if (dirty.xStart >= (XStart & ~7) && dirty.xEnd <= (XEnd | 7) &&
+            dirty.yStart >= YStart && dirty.yEnd <= YEnd)
         {
-            SendData(~redBuffer[i + j * widthByte]);
+            clearDirty();
         }
     }
 
-    // ── Trigger full panel refresh ─────────────────────────────────────────
-    // 0x22 with 0xC7: display update sequence = Load waveform + enable clock +
-    // enable analog + display sequence + disable analog + disable clock.
-    SendCommand(0x22);
-    SendData(0xC7);
-    SendCommand(0x20); // Master activation — begins the ~15–20 s e-paper refresh
-    ReadBusy();        // Block until the panel refresh is complete
-    Debug("display\r\n");
+    LoadWaveform(redChanged ? EPDDisplay::REFRESH_FULL_TRICOLOR : refreshMode);
+    TriggerRefresh();
+    ReadBusy(EPD_BUSY_SETTLE_MS, lightSleep);
+    endFrame();
+    Debug("display region\r\n");
+}
+
+void EPDDisplay::displayFill(COLOR color)
+{
+    if (color == EPDDisplay::NULL_COLOR)
+    {
+        Debug("displayFill: NULL_COLOR has nothing to fill\r\n");
+        return;
+    }
+    if (!checkDisplayReady())
+    {
+        return;
+    }
+    waitRefresh();
+    beginFrame();
+
+    // Framebuffer encoding of the color, then Auto Write RAM for each plane
+    // that controller RAM does not hold yet (works in banded mode too)
+    fillScreen(color);
+    uint8_t black = (color == EPDDisplay::BLACK) ? 0x00 : 0xFF;
+    uint8_t red = (color == EPDDisplay::RED) ? 0x00 : 0xFF;
+    AutoFillPlane(0x24, 0, black, black);
+    bool redChanged = AutoFillPlane(0x26, 1, (uint8_t)~red, red);
+    ramSynced = true;
+    clearDirty();
+
+    LoadWaveform(redChanged ? EPDDisplay::REFRESH_FULL_TRICOLOR : refreshMode);
+    TriggerRefresh();
+    ReadBusy(EPD_BUSY_SETTLE_MS, lightSleep);
+    endFrame();
+    Debug("display fill\r\n");
 }
 
 void EPDDisplay::sleep()
@@ -228,10 +391,13 @@ void EPDDisplay::sleep()
         Debug("EPD not initialized or already in sleep mode\r\n");
         return;
     }
+    waitRefresh();
+    saveFingerprint();
 
+    // Deep sleep mode 1: controller RAM is retained
     SendCommand(0x10);
     SendData(0x01);
-    delay(100);
+    transport->delayMs(100);
     isSleep = true;
     Debug("e-Paper enters sleep\r\n");
 }
@@ -246,8 +412,13 @@ void EPDDisplay::wakeUp()
     if (isSleep)
     {
         Debug("Waking up e-Paper from sleep mode\r\n");
-        reset();
-        hwInit();
+        // With a frame store the panel is known to keep its RAM in deep sleep.
+        // The live row hashes take over from the saved record.
+        if (frameStore != NULL)
+        {
+            frameStore->erase();
+        }
+        startController(frameStore != NULL);
         Debug("e-Paper wake up complete\r\n");
     }
     else
@@ -256,6 +427,11 @@ void EPDDisplay::wakeUp()
     }
 }
 
+void EPDDisplay::setLightSleep(bool enable)
+{
+    lightSleep = enable;
+}
+
 /****************************
  * PRIVATE FUNCTIONS
  ****************************/
@@ -277,111 +453,392 @@ bool EPDDisplay::checkDisplayReady()
     return true;
 }
 
-void EPDDisplay::ClearRed()
+bool EPDDisplay::UploadFrame(bool fromFront)
 {
-    uint32_t i, j;
+    const uint8_t *black = fromFront ? frontBlack : blackBuffer;
+    const uint8_t *red = fromFront ? frontRed : redBuffer;
+    DirtyRect *rect = fromFront ? &frontDirty : &dirty;
+    bool redSent = false;
 
-    ReadBusy();
-    SendCommand(0x4F);
-    SendData(0xAf);
-    SendData(0x02);
-    SendCommand(0x26); // RED
-    for (j = 0; j < heightByte; j++)
+    if (!ramSynced)
+    {
+        // After a resume, rows of unchanged bands are skipped like any other
+        restoreRowHashes(black, red);
+        redSent = UploadWindow(black, red, 0, widthByte - 1, 0, heightByte - 1);
+        ramSynced = true;
+    }
+    else if (rect->xStart <= rect->xEnd)
     {
-        for (i = 0; i < widthByte; i++)
+        // Only the byte columns / rows touched since the last upload
+        redSent = UploadWindow(black, red, rect->xStart / 8, rect->xEnd / 8, rect->yStart, rect->yEnd);
+    }
+    emptyRect(rect);
+    return redSent;
+}
+
+bool EPDDisplay::UploadWindow(const uint8_t *black, const uint8_t *red, uint16_t xByteStart, uint16_t xByteEnd, uint16_t yStart, uint16_t yEnd, bool rowsComplete)
+{
+    // ── Send Black/White plane (command 0x24) ──────────────────────────────
+    // blackBuffer encoding: bit=1 → white pixel, bit=0 → black pixel (controller native).
+    // An auto fill has already waited for BUSY. Streamed RAM writes do not
+    // raise it, so a check without settle time is enough (once per band in
+    // banded mode).
+    uint32_t autoWrites = uploadStats.autoWrites;
+    if (UploadPlane(0x24, black, 0, false, xByteStart, xByteEnd, yStart, yEnd, rowsComplete) &&
+        uploadStats.autoWrites == autoWrites)
+    {
+        ReadBusy(0);
+    }
+
+    // ── Send Red plane (command 0x26) ──────────────────────────────────────
+    // redBuffer encoding: bit=0 → red pixel, bit=1 → no red.
+    // The controller expects bit=1 for "red active", so the transport inverts
+    // each byte on the way out.
+    return UploadPlane(0x26, red, 1, true, xByteStart, xByteEnd, yStart, yEnd, rowsComplete);
+}
+
+// FNV-1a over one full buffer row. 0 is reserved for "controller row unknown".
+// Same hash for a plane row whatever its stride (interleaved or not).
+uint32_t EPDDisplay::hashRow(const uint8_t *row, uint16_t length, uint8_t stride)
+{
+    uint32_t hash = 2166136261UL;
+    for (uint16_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ row[(uint32_t)i * stride]) * 16777619UL;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+bool EPDDisplay::UploadPlane(uint8_t command, const uint8_t *buffer, uint8_t plane, bool invert,
+                             uint16_t xByteStart, uint16_t xByteEnd, uint16_t yStart, uint16_t yEnd, bool rowsComplete)
+{
+    uint16_t rowBytes = xByteEnd - xByteStart + 1;
+    uint32_t windowBytes = (uint32_t)rowBytes * (yEnd - yStart + 1);
+    uint32_t sent = 0;
+    uint16_t j;
+
+    // A uniform plane (all 0x00 / all 0xFF) sent as a whole is filled by the
+    // controller itself: two bytes on the bus instead of 58,080
+    if (rowBytes == widthByte && yStart == 0 && yEnd == heightByte - 1 && bufferRows == heightByte)
+    {
+        uint32_t imageSize = (uint32_t)widthByte * heightByte;
+        uint8_t value = buffer[0];
+#if EPD_INTERLEAVED_PLANES
+        uint32_t i = 0;
+        while (i < imageSize && buffer[2 * i] == value)
+        {
+            i++;
+        }
+        bool uniform = (i == imageSize);
+#else
+        bool uniform = EPDPlaneOps::isUniform(buffer, value, imageSize);
+#endif
+        if ((value == 0x00 || value == 0xFF) && uniform)
         {
-            SendData(0X00);
+            return AutoFillPlane(command, plane, invert ? (uint8_t)~value : value, value);
         }
     }
+
+    if (rowHash == NULL)
+    {
+        SendPlaneRows(command, buffer, invert, xByteStart, xByteEnd, yStart, yEnd);
+        uploadStats.bytesSent += windowBytes;
+        return true;
+    }
+
+    // Send runs of changed rows. Unchanged rows between two runs are sent
+    // anyway when that costs fewer bytes than reprogramming the RAM window.
+    uint32_t *hashes = rowHash + (uint32_t)plane * heightByte;
+    uint16_t gapRows = EPD_WINDOW_SETUP_BYTES / rowBytes;
+    int32_t runStart = -1;
+    int32_t runEnd = -1;
+    for (j = yStart; j <= yEnd; j++)
+    {
+        uint32_t hash = hashRow(&buffer[(uint32_t)(j - bufferRowOffset) * widthByte * EPD_PLANE_STRIDE], widthByte, EPD_PLANE_STRIDE);
+        if (hash == hashes[j])
+        {
+            continue;
+        }
+        if (runStart < 0)
+        {
+            runStart = j;
+        }
+        else if (j - runEnd - 1 > gapRows)
+        {
+            SendPlaneRows(command, buffer, invert, xByteStart, xByteEnd, runStart, runEnd);
+            sent += (uint32_t)rowBytes * (runEnd - runStart + 1);
+            runStart = j;
+        }
+        runEnd = j;
+        // After a partial-width upload the controller row only matches the
+        // buffer if nothing outside the window differs
+        hashes[j] = rowsComplete ? hash : 0;
+    }
+    if (runStart >= 0)
+    {
+        SendPlaneRows(command, buffer, invert, xByteStart, xByteEnd, runStart, runEnd);
+        sent += (uint32_t)rowBytes * (runEnd - runStart + 1);
+    }
+
+    uploadStats.bytesSent += sent;
+    uploadStats.bytesSkipped += windowBytes - sent;
+    if (sent == 0)
+    {
+        uploadStats.planesSkipped++;
+    }
+    return sent != 0;
 }
 
-void EPDDisplay::ClearBlack()
+bool EPDDisplay::AutoFillPlane(uint8_t command, uint8_t plane, uint8_t ramValue, uint8_t bufferValue)
 {
-    uint32_t i, j;
+    uint32_t imageSize = (uint32_t)widthByte * heightByte;
+    uint32_t *hashes = (rowHash != NULL) ? rowHash + (uint32_t)plane * heightByte : NULL;
+    uint8_t row[EPD_7IN5B_HD_WIDTH / 8 + 1];
+    memset(row, bufferValue, widthByte);
+    uint32_t hash = hashRow(row, widthByte);
+    uint16_t j;
+
+    if (hashes != NULL)
+    {
+        for (j = 0; j < heightByte && hashes[j] == hash; j++)
+        {
+        }
+        if (j == heightByte)
+        {
+            // Controller RAM already holds this uniform plane
+            uploadStats.bytesSkipped += imageSize;
+            uploadStats.planesSkipped++;
+            return false;
+        }
+    }
 
-    ReadBusy();
-    SendCommand(0x4F);
-    SendData(0xAf);
-    SendData(0x02);
-    SendCommand(0x24);
-    for (j = 0; j < heightByte; j++)
+    AutoWriteRam(command == 0x24 ? 0x47 : 0x46, ramValue);
+    if (hashes != NULL)
     {
-        for (i = 0; i < widthByte; i++)
+        for (j = 0; j < heightByte; j++)
         {
-            SendData(0XFF);
+            hashes[j] = hash;
         }
     }
+    uploadStats.bytesSkipped += imageSize;
+    uploadStats.autoWrites++;
+    return true;
 }
 
-void EPDDisplay::SendCommand(uint8_t Reg)
+void EPDDisplay::SendPlaneRows(uint8_t command, const uint8_t *buffer, bool invert,
+                               uint16_t xByteStart, uint16_t xByteEnd, uint16_t yStart, uint16_t yEnd)
 {
-    digitalWrite(m_DC_pin, 0);
-    digitalWrite(m_CS_pin, 0);
-    SPI_WriteByte(Reg);
-    digitalWrite(m_CS_pin, 1);
+    uint16_t rowBytes = xByteEnd - xByteStart + 1;
+
+    SetRamWindow(xByteStart, xByteEnd, yStart, yEnd);
+    SendCommand(command);
+    // One burst for the whole window; each row is a span of rowBytes bytes
+    // (110 × 528 = 58,080 bytes for the full frame).
+    BeginData();
+    for (uint16_t j = yStart; j <= yEnd; j++)
+    {
+        SendPlaneSpan(&buffer[(xByteStart + (uint32_t)(j - bufferRowOffset) * widthByte) * EPD_PLANE_STRIDE], rowBytes, invert);
+    }
+    EndData();
 }
 
-void EPDDisplay::SendData(uint8_t Data)
+void EPDDisplay::getUploadStats(UploadStats *stats)
 {
-    digitalWrite(m_DC_pin, 1);
-    digitalWrite(m_CS_pin, 0);
-    SPI_WriteByte(Data);
-    digitalWrite(m_CS_pin, 1);
+    *stats = uploadStats;
 }
 
-void EPDDisplay::ReadBusy()
+void EPDDisplay::resetUploadStats()
 {
-    uint8_t busy;
-    Debug("e-Paper busy\r\n");
-    // The BUSY pin is LOW while the controller is processing and HIGH when idle.
-    // Poll until it goes HIGH, with a 30 s watchdog to avoid hanging on hardware fault.
-    uint32_t start = millis();
-    do
+    memset(&uploadStats, 0, sizeof(uploadStats));
+}
+
+void EPDDisplay::invalidateRowHashes()
+{
+    if (rowHash != NULL)
     {
-        busy = digitalRead(m_BUSY_pin);
-        if (millis() - start > 30000)
-        {
-            Debug("e-Paper BUSY timeout!\r\n");
-            break;
-        }
-    } while (busy);
-    Debug("e-Paper busy release\r\n");
-    delay(200); // Additional settling time after BUSY clears
+        memset(rowHash, 0, 2 * (uint32_t)heightByte * sizeof(uint32_t));
+    }
 }
 
-#define GPIO_PIN_SET 1
-#define GPIO_PIN_RESET 0
+void EPDDisplay::setRowHashesWhite()
+{
+    if (rowHash == NULL)
+    {
+        return;
+    }
+    // An all-white row is 0xFF in both buffers (the red plane is stored inverted)
+    uint8_t white[EPD_7IN5B_HD_WIDTH / 8 + 1];
+    memset(white, 0xFF, widthByte);
+    uint32_t hash = hashRow(white, widthByte);
+    for (uint32_t i = 0; i < 2 * (uint32_t)heightByte; i++)
+    {
+        rowHash[i] = hash;
+    }
+}
 
-/**
- * Bit-banged SPI write: transmits one byte MSB-first using Mode 0
- * (CPOL=0, CPHA=0 — data sampled on rising clock edge).
- *
- * Timing per bit:
- *   1. Set DIN to the bit value (MSB first)
- *   2. Pulse CLK HIGH  → controller latches DIN
- *   3. Pull CLK LOW
- * CS is asserted (LOW) by the caller (SendCommand / SendData) before this
- * function is called, but this function also re-asserts CS around the byte
- * to guard against re-entrant calls.
- */
-void EPDDisplay::SPI_WriteByte(uint8_t data)
+// Buffer row j lives at controller Y address EPD_RAM_Y_TOP - j: the data
+// entry mode set in hwInit() (0x11 = 0x01) increments X and decrements Y,
+// starting from the top row 687. The X window is in pixels, 8 per byte column.
+void EPDDisplay::SetRamWindow(uint16_t xByteStart, uint16_t xByteEnd, uint16_t yStart, uint16_t yEnd)
 {
-    digitalWrite(m_CS_pin, GPIO_PIN_RESET);
+    uint16_t xs = xByteStart * 8;
+    uint16_t xe = xByteEnd * 8 + 7;
+    uint16_t ys = EPD_RAM_Y_TOP - yStart;
+    uint16_t ye = EPD_RAM_Y_TOP - yEnd;
+
+    SendCommand(0x44); // RAM X window
+    SendData(xs & 0xFF);
+    SendData(xs >> 8);
+    SendData(xe & 0xFF);
+    SendData(xe >> 8);
+
+    SendCommand(0x45); // RAM Y window
+    SendData(ys & 0xFF);
+    SendData(ys >> 8);
+    SendData(ye & 0xFF);
+    SendData(ye >> 8);
+
+    SendCommand(0x4E); // X address counter
+    SendData(xs & 0xFF);
+    SendData(xs >> 8);
+
+    SendCommand(0x4F); // Y address counter
+    SendData(ys & 0xFF);
+    SendData(ys >> 8);
+}
 
-    for (int i = 0; i < 8; i++)
+void EPDDisplay::markAllDirty()
+{
+    dirty.xStart = 0;
+    dirty.xEnd = widthMemory - 1;
+    dirty.yStart = 0;
+    dirty.yEnd = heightMemory - 1;
+}
+
+void EPDDisplay::clearDirty()
+{
+    emptyRect(&dirty);
+}
+
+void EPDDisplay::emptyRect(DirtyRect *rect)
+{
+    rect->xStart = 0xFFFF;
+    rect->xEnd = 0;
+    rect->yStart = 0xFFFF;
+    rect->yEnd = 0;
+}
+
+void EPDDisplay::unionRect(DirtyRect *rect, const DirtyRect *other)
+{
+    if (other->xStart > other->xEnd)
     {
-        // Output the MSB of `data` onto DIN
-        if ((data & 0x80) == 0)
-            digitalWrite(m_DIN_pin, GPIO_PIN_RESET);
-        else
-            digitalWrite(m_DIN_pin, GPIO_PIN_SET);
+        return; // Nothing to add
+    }
+    if (other->xStart < rect->xStart)
+        rect->xStart = other->xStart;
+    if (other->xEnd > rect->xEnd)
+        rect->xEnd = other->xEnd;
+    if (other->yStart < rect->yStart)
+        rect->yStart = other->yStart;
+    if (other->yEnd > rect->yEnd)
+        rect->yEnd = other->yEnd;
+}
+
+void EPDDisplay::TriggerRefresh()
+{
+    // 0x22: display update sequence of the waveform chosen by LoadWaveform()
+    // (0xC7 for the full refresh = enable clock + enable analog + display
+    // sequence + disable analog + disable clock).
+    SendCommand(0x22);
+    SendData(activeUpdateSequence);
+    SendCommand(0x20); // Master activation — begins the ~15–20 s e-paper refresh
+}
 
-        data <<= 1; // Shift next bit into MSB position
+void EPDDisplay::ClearRed()
+{
+    AutoWriteRam(0x46, 0x00); // Red RAM all 0 = no red
+}
+
+void EPDDisplay::ClearBlack()
+{
+    AutoWriteRam(0x47, 0xFF); // BW RAM all 1 = white
+}
+
+// Auto Write RAM (0x46 Red / 0x47 BW) fills the whole RAM window in the
+// controller. Pattern byte: bit 7 = first value, bits 6:4 / 2:0 = step
+// height / width, where 7 means "whole window" (a single, uniform block).
+void EPDDisplay::AutoWriteRam(uint8_t command, uint8_t value)
+{
+    SetRamWindow(0, widthByte - 1, 0, heightByte - 1);
+    SendCommand(command);
+    SendData(value ? 0xF7 : 0x77);
+    // The controller is busy while it fills the RAM; the BUSY release is
+    // all the wait needed, without the settle time of a refresh
+    ReadBusy(0);
+}
+
+void EPDDisplay::SendCommand(uint8_t Reg)
+{
+    transport->writeCommand(Reg);
+}
 
-        // Rising edge: controller latches DIN
-        digitalWrite(m_CLK_pin, GPIO_PIN_SET);
-        // Falling edge: prepare for next bit
-        digitalWrite(m_CLK_pin, GPIO_PIN_RESET);
+void EPDDisplay::SendData(uint8_t Data)
+{
+    transport->writeData(Data);
+}
+
+void EPDDisplay::BeginData()
+{
+    transport->beginData();
+}
+
+void EPDDisplay::SendDataSpan(const uint8_t *Data, uint32_t Length, bool Invert)
+{
+    transport->writeDataSpan(Data, Length, Invert);
+}
+
+void EPDDisplay::SendPlaneSpan(const uint8_t *Data, uint32_t Length, bool Invert)
+{
+#if EPD_INTERLEAVED_PLANES
+    // De-interleaved by the transport while streaming
+    transport->writeDataStrided(Data, Length, EPD_PLANE_STRIDE, Invert);
+#else
+    transport->writeDataSpan(Data, Length, Invert);
+#endif
+}
+
+void EPDDisplay::SendDataRepeat(uint8_t Data, uint32_t Count)
+{
+    transport->writeDataRepeat(Data, Count);
+}
+
+void EPDDisplay::EndData()
+{
+    transport->endData();
+}
+
+void EPDDisplay::ReadBusy(uint32_t guard_ms, bool sleep)
+{
+    Debug("e-Paper busy\r\n");
+    // The BUSY pin is HIGH while the controller is processing and LOW when idle.
+    // Wait for LOW, with a 30 s watchdog to avoid hanging on hardware fault.
+    uint32_t start = transport->nowUs();
+    bool released;
+    if (sleep)
+    {
+        uint32_t slept = 0;
+        released = transport->sleepWhileBusy(EPD_BUSY_TIMEOUT_MS, &slept);
+        frameTiming.sleptUs += slept;
+    }
+    else
+    {
+        released = transport->waitBusy(EPD_BUSY_TIMEOUT_MS);
     }
-    digitalWrite(m_CS_pin, GPIO_PIN_SET);
+    if (!released)
+    {
+        Debug("e-Paper BUSY timeout!\r\n");
+    }
+    frameTiming.busyUs += transport->nowUs() - start;
+    Debug("e-Paper busy release\r\n");
+    Settle(guard_ms); // Additional settling time after BUSY clears
 }
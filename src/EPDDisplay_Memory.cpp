@@ -0,0 +1,254 @@
+/**
+ * @file EPDDisplay_Memory.cpp
+ * @brief Framebuffer allocation policy and placement reporting.
+ *
+ * Each plane is 58 KB (a few KB in banded mode). Where it lives decides how
+ * fast it uploads:
+ *   - internal DMA-capable RAM: the hardware SPI transport hands rows to the
+ *     DMA engine directly, no bounce copy
+ *   - PSRAM: slower CPU access and must be copied through a bounce buffer for
+ *     DMA, but keeps ~116 KB of internal heap free; the bit-banged transport
+ *     reads every byte with the CPU anyway, so it loses nothing here
+ *
+ * ALLOC_AUTO therefore asks the transport (EPDTransport::prefersDmaMemory())
+ * and tries the fast memory first, then the other one. The explicit policies
+ * never fall back, so a board that must keep its planes in PSRAM fails loudly
+ * instead of silently eating internal RAM.
+ *
+ * On ESP32 this goes through heap_caps_malloc(); on host builds the same calls
+ * hit the allocator shim in EPDHostShim, which logs every request. Other
+ * Arduino targets have a single heap and use malloc().
+ *
+ * With EPD_INTERLEAVED_PLANES a plane pair is a single block of twice the
+ * plane size: redBuffer = blackBuffer + 1, each plane read with a stride of 2.
+ */
+#include "EPDDisplay.h"
+
+#if defined(ESP32)
+#include "esp_heap_caps.h"
+#if __has_include("esp_memory_utils.h")
+#include "esp_memory_utils.h"
+#else
+#include "soc/soc_memory_layout.h"
+#endif
+#endif
+
+#if defined(ESP32) || !defined(ARDUINO)
+#define EPD_HAS_HEAP_CAPS 1
+#else
+#define EPD_HAS_HEAP_CAPS 0
+#endif
+
+#ifdef DEBUG
+static const char *placementName(EPDDisplay::MEMORY_PLACEMENT placement)
+{
+    switch (placement)
+    {
+    case EPDDisplay::MEMORY_INTERNAL_DMA:
+        return "internal DMA RAM";
+    case EPDDisplay::MEMORY_INTERNAL:
+        return "internal RAM";
+    case EPDDisplay::MEMORY_PSRAM:
+        return "PSRAM";
+    default:
+        return "none";
+    }
+}
+#endif
+
+void EPDDisplay::setAllocationPolicy(ALLOC_POLICY policy)
+{
+    if (isInitialized)
+    {
+        Debug("setAllocationPolicy must be called before initialize\r\n");
+        return;
+    }
+    if (policy == EPDDisplay::ALLOC_AUTO || policy == EPDDisplay::ALLOC_INTERNAL_DMA ||
+        policy == EPDDisplay::ALLOC_PSRAM)
+    {
+        allocPolicy = policy;
+    }
+    else
+    {
+        Debug("policy should be EPDDisplay::ALLOC_AUTO, EPDDisplay::ALLOC_INTERNAL_DMA, EPDDisplay::ALLOC_PSRAM (use setFramebuffers for caller buffers)\r\n");
+    }
+}
+
+void EPDDisplay::setFramebuffers(uint8_t *black_buffer, uint8_t *red_buffer)
+{
+    if (isInitialized)
+    {
+        Debug("setFramebuffers must be called before initialize\r\n");
+        return;
+    }
+#if EPD_INTERLEAVED_PLANES
+    // Both planes live in black_buffer
+    red_buffer = (black_buffer != NULL) ? black_buffer + 1 : NULL;
+#endif
+    if (black_buffer == NULL || red_buffer == NULL)
+    {
+        Debug("setFramebuffers: both buffers are required\r\n");
+        return;
+    }
+    allocPolicy = EPDDisplay::ALLOC_CALLER;
+    blackBuffer = black_buffer;
+    redBuffer = red_buffer;
+    ownsBuffers = false;
+}
+
+void EPDDisplay::getBufferPlacement(MEMORY_PLACEMENT *black, MEMORY_PLACEMENT *red)
+{
+    // Before initialize() blackBuffer may already hold caller buffers
+    if (black != NULL)
+    {
+        *black = placementOf(blackBuffer);
+    }
+    if (red != NULL)
+    {
+        *red = placementOf(redBuffer);
+    }
+}
+
+EPDDisplay::MEMORY_PLACEMENT EPDDisplay::placementOf(const void *ptr)
+{
+    if (ptr == NULL)
+    {
+        return EPDDisplay::MEMORY_NONE;
+    }
+#if EPD_HAS_HEAP_CAPS
+    if (esp_ptr_external_ram(ptr))
+    {
+        return EPDDisplay::MEMORY_PSRAM;
+    }
+    if (esp_ptr_dma_capable(ptr))
+    {
+        return EPDDisplay::MEMORY_INTERNAL_DMA;
+    }
+#endif
+    return EPDDisplay::MEMORY_INTERNAL;
+}
+
+uint8_t *EPDDisplay::allocPlane(uint32_t size, ALLOC_POLICY policy)
+{
+#if EPD_HAS_HEAP_CAPS
+    const uint32_t dmaCaps = MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    const uint32_t psramCaps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+
+    switch (policy)
+    {
+    case EPDDisplay::ALLOC_INTERNAL_DMA:
+        return (uint8_t *)heap_caps_malloc(size, dmaCaps);
+    case EPDDisplay::ALLOC_PSRAM:
+        return psramFound() ? (uint8_t *)heap_caps_malloc(size, psramCaps) : NULL;
+    default:
+        break;
+    }
+
+    uint8_t *plane = NULL;
+    bool dmaFirst = transport != NULL && transport->prefersDmaMemory();
+    if (dmaFirst)
+    {
+        plane = (uint8_t *)heap_caps_malloc(size, dmaCaps);
+    }
+    if (plane == NULL && psramFound())
+    {
+        plane = (uint8_t *)heap_caps_malloc(size, psramCaps);
+    }
+    if (plane == NULL && !dmaFirst)
+    {
+        plane = (uint8_t *)heap_caps_malloc(size, dmaCaps);
+    }
+    if (plane == NULL)
+    {
+        // Any byte-addressable memory left (internal, not DMA-capable)
+        plane = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    return plane;
+#else
+    (void)policy;
+    return (uint8_t *)malloc(size);
+#endif
+}
+
+bool EPDDisplay::allocPlanePair(uint8_t **black, uint8_t **red, uint32_t size, ALLOC_POLICY policy)
+{
+#if EPD_INTERLEAVED_PLANES
+    *black = allocPlane(2 * size, policy);
+    *red = (*black != NULL) ? *black + 1 : NULL;
+#else
+    *black = allocPlane(size, policy);
+    *red = allocPlane(size, policy);
+#endif
+    if (*black == NULL || *red == NULL)
+    {
+        freePlanePair(*black, *red);
+        *black = NULL;
+        *red = NULL;
+        return false;
+    }
+    return true;
+}
+
+void EPDDisplay::freePlanePair(uint8_t *black, uint8_t *red)
+{
+    freePlane(black);
+#if !EPD_INTERLEAVED_PLANES
+    freePlane(red);
+#else
+    (void)red;
+#endif
+}
+
+void EPDDisplay::freePlane(uint8_t *plane)
+{
+    if (plane == NULL)
+    {
+        return;
+    }
+#if EPD_HAS_HEAP_CAPS
+    heap_caps_free(plane);
+#else
+    free(plane);
+#endif
+}
+
+bool EPDDisplay::allocateFramebuffers(uint32_t size)
+{
+    if (allocPolicy == EPDDisplay::ALLOC_CALLER)
+    {
+        if (blackBuffer == NULL || redBuffer == NULL)
+        {
+            Debug("ALLOC_CALLER without buffers, call setFramebuffers first\r\n");
+            return false;
+        }
+        return true;
+    }
+
+    ownsBuffers = true;
+    if (!allocPlanePair(&blackBuffer, &redBuffer, size, allocPolicy))
+    {
+        Debug("Failed to allocate memory for framebuffers\r\n");
+        return false;
+    }
+
+#ifdef DEBUG
+    MEMORY_PLACEMENT black, red;
+    getBufferPlacement(&black, &red);
+    Debug("Framebuffers: black in ");
+    Debug(placementName(black));
+    Debug(", red in ");
+    Debug(placementName(red));
+    Debug("\r\n");
+#endif
+    return true;
+}
+
+void EPDDisplay::freeFramebuffers()
+{
+    if (ownsBuffers)
+    {
+        freePlanePair(blackBuffer, redBuffer);
+    }
+    blackBuffer = NULL;
+    redBuffer = NULL;
+}
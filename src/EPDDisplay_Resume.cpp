@@ -0,0 +1,168 @@
+/**
+ * @file EPDDisplay_Resume.cpp
+ * @brief Deep-sleep resume: fingerprint of the displayed frame in an EPDFrameStore.
+ *
+ * sleep() puts the controller in deep sleep mode 1, which keeps both RAM
+ * planes, and the panel keeps its image without power. What the MCU loses in
+ * its own deep sleep is the knowledge of that frame, i.e. the row hash table.
+ * With a frame store set (setFrameStore()):
+ *   - sleep() folds the row hashes into one fingerprint per band of
+ *     EPD_FINGERPRINT_BAND_ROWS rows and plane (66 × 2 hashes, 536 bytes)
+ *     and saves it
+ *   - initialize() loads it and erases it from the store; with a valid record
+ *     the init sequence skips the RAM auto write, so controller RAM still
+ *     holds the frame on the panel
+ *   - the first full upload hashes the new frame band by band. Matching
+ *     bands get their row hashes back, so UploadPlane() skips those rows as
+ *     after any other frame and only the changed rows are sent
+ *   - if nothing at all was sent, display() skips the refresh
+ *   - wakeUp() (panel slept, MCU did not) keeps RAM and the live row hashes
+ *
+ * A band whose rows are not all known at sleep() (partial-width uploads,
+ * no upload yet) is stored as 0 and always resent. Erasing the record at
+ * load means a crash after a later upload can never resume against a stale
+ * fingerprint.
+ *
+ * Banded mode has no full frame to compare, so its first frame after a
+ * resume is uploaded in full.
+ */
+#include "EPDDisplay.h"
+
+// "EPDF" + layout version: a record from another layout never matches
+#define EPD_FINGERPRINT_MAGIC 0x45504401UL
+
+// Fingerprint of one band from its row hashes, 0 if any row is unknown
+static uint32_t bandHash(const uint32_t *rows, uint16_t count)
+{
+    uint32_t hash = 2166136261UL;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (rows[i] == 0)
+        {
+            return 0;
+        }
+        hash = (hash ^ rows[i]) * 16777619UL;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+// FNV-1a over the record up to the check field
+static uint32_t recordCheck(const void *record, uint32_t size)
+{
+    const uint8_t *bytes = (const uint8_t *)record;
+    uint32_t hash = 2166136261UL;
+    for (uint32_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+void EPDDisplay::setFrameStore(EPDFrameStore *store)
+{
+    if (isInitialized)
+    {
+        Debug("setFrameStore must be called before initialize\r\n");
+        return;
+    }
+    if (store != NULL && fingerprint == NULL)
+    {
+        fingerprint = (FrameFingerprint *)malloc(sizeof(FrameFingerprint));
+        if (fingerprint == NULL)
+        {
+            Debug("Failed to allocate frame fingerprint\r\n");
+            return;
+        }
+    }
+    if (fingerprint != NULL)
+    {
+        fingerprint->magic = 0;
+    }
+    frameStore = store;
+}
+
+void EPDDisplay::saveFingerprint()
+{
+    if (frameStore == NULL || fingerprint == NULL)
+    {
+        return;
+    }
+    if (rowHash == NULL || !ramSynced)
+    {
+        // Controller RAM content unknown: nothing to resume from
+        frameStore->erase();
+        return;
+    }
+
+    for (uint8_t plane = 0; plane < 2; plane++)
+    {
+        const uint32_t *hashes = rowHash + (uint32_t)plane * heightByte;
+        for (uint16_t band = 0; band < EPD_FINGERPRINT_BANDS; band++)
+        {
+            uint16_t first = band * EPD_FINGERPRINT_BAND_ROWS;
+            uint16_t count = (heightByte - first < EPD_FINGERPRINT_BAND_ROWS) ? heightByte - first : EPD_FINGERPRINT_BAND_ROWS;
+            fingerprint->bands[plane][band] = bandHash(hashes + first, count);
+        }
+    }
+    fingerprint->magic = EPD_FINGERPRINT_MAGIC;
+    fingerprint->check = recordCheck(fingerprint, offsetof(FrameFingerprint, check));
+    if (!frameStore->save(fingerprint, sizeof(FrameFingerprint)))
+    {
+        Debug("Failed to save frame fingerprint\r\n");
+    }
+    // Only valid while this instance lives; a resume loads it again
+    fingerprint->magic = 0;
+}
+
+bool EPDDisplay::loadFingerprint()
+{
+    if (frameStore == NULL || fingerprint == NULL)
+    {
+        return false;
+    }
+    bool valid = frameStore->load(fingerprint, sizeof(FrameFingerprint)) &&
+                 fingerprint->magic == EPD_FINGERPRINT_MAGIC &&
+                 fingerprint->check == recordCheck(fingerprint, offsetof(FrameFingerprint, check));
+    if (!valid)
+    {
+        fingerprint->magic = 0;
+        return false;
+    }
+    frameStore->erase();
+    Debug("Resuming with the frame saved before deep sleep\r\n");
+    return true;
+}
+
+void EPDDisplay::restoreRowHashes(const uint8_t *black, const uint8_t *red)
+{
+    if (fingerprint == NULL || fingerprint->magic != EPD_FINGERPRINT_MAGIC)
+    {
+        return;
+    }
+    fingerprint->magic = 0;
+    if (rowHash == NULL || bufferRows != heightByte)
+    {
+        return;
+    }
+
+    for (uint8_t plane = 0; plane < 2; plane++)
+    {
+        const uint8_t *buffer = (plane == 0) ? black : red;
+        uint32_t *hashes = rowHash + (uint32_t)plane * heightByte;
+        for (uint16_t band = 0; band < EPD_FINGERPRINT_BANDS; band++)
+        {
+            uint16_t first = band * EPD_FINGERPRINT_BAND_ROWS;
+            uint16_t count = (heightByte - first < EPD_FINGERPRINT_BAND_ROWS) ? heightByte - first : EPD_FINGERPRINT_BAND_ROWS;
+            for (uint16_t j = first; j < first + count; j++)
+            {
+                hashes[j] = hashRow(&buffer[(uint32_t)j * widthByte * EPD_PLANE_STRIDE], widthByte, EPD_PLANE_STRIDE);
+            }
+            uint32_t stored = fingerprint->bands[plane][band];
+            if (stored == 0 || bandHash(hashes + first, count) != stored)
+            {
+                // Changed (or unknown) band: its rows must be sent
+                memset(hashes + first, 0, count * sizeof(uint32_t));
+            }
+        }
+    }
+}
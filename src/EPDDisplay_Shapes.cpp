@@ -14,11 +14,35 @@
  *   conditionally step the minor axis when error exceeds the threshold.
  *   Supports dotted style by counting drawn vs. skipped pixels.
  *
- * drawRectangle — Four drawLine calls (outline) or horizontal scan-fill.
+ * drawRectangle — Four drawLine calls (outline) or one fillRect() (filled).
+ *
+ * drawHSpan / drawVSpan — runs of pixels written byte-wise through
+ *   EPDPixelWriter::fill(): masked edge bytes, memset() for the full bytes
+ *   between them. Every filled shape is built from such spans.
  *
  * drawPoint — Square block of (2*width-1)² pixels centered on (x,y).
+ *
+ * One-pixel-wide circles and lines, and drawPoint's square, clip their
+ * bounding box once and write through EPDPixelWriter (see EPDPixelWriter.h)
+ * instead of calling drawPixel() per pixel. Wider outlines still go through
+ * drawPoint().
  */
-#include "EPDDisplay.h"
+#include "EPDPixelWriter.h"
+
+// One plotted point of a circle or line: unchecked writer for 1-pixel
+// lines, a drawPoint() square otherwise
+static inline void plotPoint(EPDDisplay *display, EPDPixelWriter &writer, EPDColorMask mask,
+                             int32_t x, int32_t y, EPDDisplay::COLOR color, uint8_t line_width)
+{
+    if (line_width == 1)
+    {
+        writer.putClipped(x, y, mask);
+    }
+    else
+    {
+        display->drawPoint(x, y, color, line_width);
+    }
+}
 
 void EPDDisplay::drawCircle(uint16_t Xcenter, uint16_t Ycenter, uint16_t radius, COLOR color, uint8_t line_width, DRAW_FILL draw_fill)
 {
@@ -27,6 +51,12 @@ void EPDDisplay::drawCircle(uint16_t Xcenter, uint16_t Ycenter, uint16_t radius,
         Debug("Paint_DrawCircle Input exceeds the normal display range\r\n");
         return;
     }
+    if (color == EPDDisplay::NULL_COLOR)
+    {
+        return;
+    }
+    EPDPixelWriter writer(this);
+    EPDColorMask mask = epdColorMask(color);
 
     // Bresenham midpoint circle: start at top (0, R), iterate to the 45° point.
     // Esp is the decision variable: Esp = 3 - 2*R initially.
@@ -38,22 +68,22 @@ void EPDDisplay::drawCircle(uint16_t Xcenter, uint16_t Ycenter, uint16_t radius,
 
     int16_t Esp = 3 - (radius << 1); // 3 - 2*R
 
-    int16_t sCountY;
     if (draw_fill)
     {
+        // Spans grown by line_width - 1 on every side, like drawPoint() squares
+        int32_t grow = (int32_t)line_width - 1;
+        if (line_width == 0 ||
+            !writer.begin(Xcenter - radius - grow, Ycenter - radius - grow, Xcenter + radius + grow, Ycenter + radius + grow))
+        {
+            return;
+        }
         while (Xcurrent <= Ycurrent)
-        { // Realistic circles
-            for (sCountY = Xcurrent; sCountY <= Ycurrent; sCountY++)
-            {
-                drawPoint(Xcenter + Xcurrent, Ycenter + sCountY, color, line_width); // 1
-                drawPoint(Xcenter - Xcurrent, Ycenter + sCountY, color, line_width); // 2
-                drawPoint(Xcenter - sCountY, Ycenter + Xcurrent, color, line_width); // 3
-                drawPoint(Xcenter - sCountY, Ycenter - Xcurrent, color, line_width); // 4
-                drawPoint(Xcenter - Xcurrent, Ycenter - sCountY, color, line_width); // 5
-                drawPoint(Xcenter + Xcurrent, Ycenter - sCountY, color, line_width); // 6
-                drawPoint(Xcenter + sCountY, Ycenter - Xcurrent, color, line_width); // 7
-                drawPoint(Xcenter + sCountY, Ycenter + Xcurrent, color, line_width); // 0
-            }
+        {
+            // Rows Ycenter ± Xcurrent reach out to Ycurrent, rows Ycenter ± Ycurrent to Xcurrent
+            writer.fill(Xcenter - Ycurrent - grow, Ycenter + Xcurrent - grow, Xcenter + Ycurrent + grow, Ycenter + Xcurrent + grow, mask);
+            writer.fill(Xcenter - Ycurrent - grow, Ycenter - Xcurrent - grow, Xcenter + Ycurrent + grow, Ycenter - Xcurrent + grow, mask);
+            writer.fill(Xcenter - Xcurrent - grow, Ycenter + Ycurrent - grow, Xcenter + Xcurrent + grow, Ycenter + Ycurrent + grow, mask);
+            writer.fill(Xcenter - Xcurrent - grow, Ycenter - Ycurrent - grow, Xcenter + Xcurrent + grow, Ycenter - Ycurrent + grow, mask);
             if (Esp < 0)
                 Esp += 4 * Xcurrent + 6;
             else
@@ -66,16 +96,21 @@ void EPDDisplay::drawCircle(uint16_t Xcenter, uint16_t Ycenter, uint16_t radius,
     }
     else
     {
+        if (line_width == 1 &&
+            !writer.begin(Xcenter - radius, Ycenter - radius, Xcenter + radius, Ycenter + radius))
+        {
+            return;
+        }
         while (Xcurrent <= Ycurrent)
         {
-            drawPoint(Xcenter + Xcurrent, Ycenter + Ycurrent, color, line_width); // 1
-            drawPoint(Xcenter - Xcurrent, Ycenter + Ycurrent, color, line_width); // 2
-            drawPoint(Xcenter - Ycurrent, Ycenter + Xcurrent, color, line_width); // 3
-            drawPoint(Xcenter - Ycurrent, Ycenter - Xcurrent, color, line_width); // 4
-            drawPoint(Xcenter - Xcurrent, Ycenter - Ycurrent, color, line_width); // 5
-            drawPoint(Xcenter + Xcurrent, Ycenter - Ycurrent, color, line_width); // 6
-            drawPoint(Xcenter + Ycurrent, Ycenter - Xcurrent, color, line_width); // 7
-            drawPoint(Xcenter + Ycurrent, Ycenter + Xcurrent, color, line_width); // 0
+            plotPoint(this, writer, mask, Xcenter + Xcurrent, Ycenter + Ycurrent, color, line_width); // 1
+            plotPoint(this, writer, mask, Xcenter - Xcurrent, Ycenter + Ycurrent, color, line_width); // 2
+            plotPoint(this, writer, mask, Xcenter - Ycurrent, Ycenter + Xcurrent, color, line_width); // 3
+            plotPoint(this, writer, mask, Xcenter - Ycurrent, Ycenter - Xcurrent, color, line_width); // 4
+            plotPoint(this, writer, mask, Xcenter - Xcurrent, Ycenter - Ycurrent, color, line_width); // 5
+            plotPoint(this, writer, mask, Xcenter + Xcurrent, Ycenter - Ycurrent, color, line_width); // 6
+            plotPoint(this, writer, mask, Xcenter + Ycurrent, Ycenter - Xcurrent, color, line_width); // 7
+            plotPoint(this, writer, mask, Xcenter + Ycurrent, Ycenter + Xcurrent, color, line_width); // 0
 
             if (Esp < 0)
                 Esp += 4 * Xcurrent + 6;
@@ -93,10 +128,26 @@ void EPDDisplay::drawRectangle(uint16_t Xstart, uint16_t Ystart, uint16_t Xend,
 {
     if (draw_Fill)
     {
-        uint16_t Ypoint;
-        for (Ypoint = Ystart; Ypoint < Yend; Ypoint++)
+        if (Xstart > width || Xend > width || line_width == 0)
+        {
+            Debug("drawRectangle Input exceeds the normal display range\r\n");
+            return;
+        }
+        if (color == EPDDisplay::NULL_COLOR || Yend <= Ystart)
+        {
+            return;
+        }
+        // Rows Ystart .. Yend - 1, grown by line_width - 1 like drawLine() rows of that width
+        int32_t grow = (int32_t)line_width - 1;
+        int32_t x0 = (Xstart < Xend ? Xstart : Xend) - grow;
+        int32_t x1 = (Xstart < Xend ? Xend : Xstart) + grow;
+        int32_t y0 = (int32_t)Ystart - grow;
+        int32_t y1 = (int32_t)Yend - 1 + grow;
+        x0 = x0 < 0 ? 0 : x0;
+        y0 = y0 < 0 ? 0 : y0;
+        if (x0 < width && y0 < height)
         {
-            drawLine(Xstart, Ypoint, Xend, Ypoint, color, line_width, EPDDisplay::LINE_SOLID);
+            fillRect(x0, y0, x1 - x0 + 1, y1 - y0 + 1, color);
         }
     }
     else
@@ -116,6 +167,18 @@ void EPDDisplay::drawLine(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint1
         Debug("drawLine Input exceeds the normal display range\r\n");
         return;
     }
+    if (color == EPDDisplay::NULL_COLOR)
+    {
+        return;
+    }
+    EPDPixelWriter writer(this);
+    EPDColorMask mask = epdColorMask(color);
+    if (line_width == 1 &&
+        !writer.begin(Xstart < Xend ? Xstart : Xend, Ystart < Yend ? Ystart : Yend,
+                      Xstart < Xend ? Xend : Xstart, Ystart < Yend ? Yend : Ystart))
+    {
+        return;
+    }
 
     uint16_t Xpoint = Xstart;
     uint16_t Ypoint = Ystart;
@@ -141,14 +204,7 @@ void EPDDisplay::drawLine(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint1
             Dotted_Len++;
             if (Dotted_Len < (line_width * 3))
             {
-                if (line_width > 1)
-                {
-                    drawPoint(Xpoint, Ypoint, color, line_width);
-                }
-                else
-                {
-                    drawPixel(Xpoint, Ypoint, color);
-                }
+                plotPoint(this, writer, mask, Xpoint, Ypoint, color, line_width);
             }
             else if (Dotted_Len <= (line_width * 4))
             {
@@ -160,14 +216,7 @@ void EPDDisplay::drawLine(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint1
         }
         else
         {
-            if (line_width > 1)
-            {
-                drawPoint(Xpoint, Ypoint, color, line_width);
-            }
-            else
-            {
-                drawPixel(Xpoint, Ypoint, color);
-            }
+            plotPoint(this, writer, mask, Xpoint, Ypoint, color, line_width);
         }
         if (2 * Esp >= dy)
         {
@@ -186,6 +235,42 @@ void EPDDisplay::drawLine(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint1
     }
 }
 
+void EPDDisplay::drawHSpan(uint16_t x, uint16_t y, uint16_t length, COLOR color)
+{
+    if (x >= width || y >= height)
+    {
+        Debug("drawHSpan Input exceeds the normal display range\r\n");
+        return;
+    }
+    if (color == EPDDisplay::NULL_COLOR || length == 0)
+    {
+        return;
+    }
+    EPDPixelWriter writer(this);
+    if (writer.begin(x, y, (int32_t)x + length - 1, y))
+    {
+        writer.fill(x, y, (int32_t)x + length - 1, y, epdColorMask(color));
+    }
+}
+
+void EPDDisplay::drawVSpan(uint16_t x, uint16_t y, uint16_t length, COLOR color)
+{
+    if (x >= width || y >= height)
+    {
+        Debug("drawVSpan Input exceeds the normal display range\r\n");
+        return;
+    }
+    if (color == EPDDisplay::NULL_COLOR || length == 0)
+    {
+        return;
+    }
+    EPDPixelWriter writer(this);
+    if (writer.begin(x, y, x, (int32_t)y + length - 1))
+    {
+        writer.fill(x, y, x, (int32_t)y + length - 1, epdColorMask(color));
+    }
+}
+
 void EPDDisplay::drawPoint(uint16_t Xpoint, uint16_t Ypoint, COLOR color, uint8_t point_width)
 {
     if ((Xpoint + point_width - 1) > width || (Ypoint + point_width - 1) > height)
@@ -193,19 +278,24 @@ void EPDDisplay::drawPoint(uint16_t Xpoint, uint16_t Ypoint, COLOR color, uint8_
         Debug("drawPoint Input exceeds the normal display range\r\n");
         return;
     }
+    if (color == EPDDisplay::NULL_COLOR)
+    {
+        return;
+    }
 
-    int16_t XDir_Num, YDir_Num;
-    int16_t offset = (int16_t)(point_width - 1);
-
-    for (XDir_Num = 0; XDir_Num < 2 * point_width - 1; XDir_Num++)
+    // The square is clipped once (left and top edges, rotation limits, band)
+    int32_t offset = (int32_t)point_width - 1;
+    EPDPixelWriter writer(this);
+    if (!writer.begin(Xpoint - offset, Ypoint - offset, Xpoint + offset, Ypoint + offset))
+    {
+        return;
+    }
+    EPDColorMask mask = epdColorMask(color);
+    for (int32_t y = writer.top(); y <= writer.bottom(); y++)
     {
-        if ((int16_t)Xpoint + XDir_Num - offset < 0)
-            continue;
-        for (YDir_Num = 0; YDir_Num < 2 * point_width - 1; YDir_Num++)
+        for (int32_t x = writer.left(); x <= writer.right(); x++)
         {
-            if ((int16_t)Ypoint + YDir_Num - offset < 0)
-                continue;
-            drawPixel(Xpoint + XDir_Num - offset, Ypoint + YDir_Num - offset, color);
+            writer.put(x, y, mask);
         }
     }
 }
@@ -14,8 +14,12 @@
  *   via a binary search in fontExtCodepoints[]. The matched index is used as
  *   an offset into the per-font extended bitmap table (fontExtX_Table[]).
  *   Unsupported codepoints fall back to rendering '?'.
+ *
+ * Glyph output:
+ *   drawCharBitmap() clips the glyph cell once and writes the visible part
+ *   through EPDPixelWriter, with both colors resolved to plane masks up front.
  */
-#include "EPDDisplay.h"
+#include "EPDPixelWriter.h"
 
 // Extended character tables (defined in src/fonts/font_ext.cpp — auto-generated)
 extern const uint8_t fontExt8_Table[];
@@ -132,27 +136,31 @@ void EPDDisplay::drawString(uint16_t Xstart, uint16_t Ystart, const char *pStrin
 
 void EPDDisplay::drawCharBitmap(uint16_t Xpoint, uint16_t Ypoint, const uint8_t *ptr, sFONT *Font, COLOR color_foreground, COLOR color_background)
 {
-    for (uint16_t Page = 0; Page < Font->height; Page++)
+    // Clip the glyph cell once, then write only its visible part
+    EPDPixelWriter writer(this);
+    if (!writer.begin(Xpoint, Ypoint, Xpoint + Font->width - 1, Ypoint + Font->height - 1))
+    {
+        return;
+    }
+    bool drawForeground = (color_foreground != EPDDisplay::NULL_COLOR);
+    bool drawBackground = (color_background != EPDDisplay::NULL_COLOR);
+    EPDColorMask foreground = epdColorMask(color_foreground);
+    EPDColorMask background = epdColorMask(color_background);
+
+    uint16_t rowBytes = Font->width / 8 + (Font->width % 8 ? 1 : 0);
+    uint16_t firstColumn = writer.left() - Xpoint;
+    uint16_t lastColumn = writer.right() - Xpoint;
+    for (int32_t y = writer.top(); y <= writer.bottom(); y++)
     {
-        for (uint16_t Column = 0; Column < Font->width; Column++)
+        const uint8_t *row = ptr + (uint32_t)(y - Ypoint) * rowBytes;
+        for (uint16_t Column = firstColumn; Column <= lastColumn; Column++)
         {
-            if (EPDDisplay::NULL_COLOR == color_background)
-            {
-                if (*ptr & (0x80 >> (Column % 8)))
-                    drawPixel(Xpoint + Column, Ypoint + Page, color_foreground);
-            }
-            else
+            bool ink = (row[Column / 8] & (0x80 >> (Column % 8))) != 0;
+            if (ink ? drawForeground : drawBackground)
             {
-                if (*ptr & (0x80 >> (Column % 8)))
-                    drawPixel(Xpoint + Column, Ypoint + Page, color_foreground);
-                else
-                    drawPixel(Xpoint + Column, Ypoint + Page, color_background);
+                writer.put(Xpoint + Column, y, ink ? foreground : background);
             }
-            if (Column % 8 == 7)
-                ptr++;
         }
-        if (Font->width % 8 != 0)
-            ptr++;
     }
 }
 
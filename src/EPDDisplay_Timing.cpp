@@ -0,0 +1,94 @@
+/**
+ * @file EPDDisplay_Timing.cpp
+ * @brief Per-frame time breakdown: render, upload, busy, settle.
+ *
+ * Every frame-producing call brackets its work with beginFrame() and
+ * endFrame(). In between, the waits report themselves:
+ *   - ReadBusy() adds the time BUSY stayed high to busyUs, and its settle
+ *     delay after the release (through Settle()) to settleUs; with
+ *     setLightSleep() the part of the wait spent in light sleep also goes
+ *     to sleptUs
+ *   - renderBanded() adds each draw callback to renderUs and moves the frame
+ *     start past it, so drawing never counts as upload time
+ *   - an asynchronous frame counts everything from the refresh trigger to
+ *     the moment its completion is observed as busyUs
+ * Whatever is left of the frame is uploadUs: SPI traffic and the CPU work
+ * around it (hashing, window setup).
+ *
+ * All times come from the transport clock (EPDTransport::nowUs()). On a host
+ * with EPDMockTransport::setLatencyModel() this is virtual time, so the
+ * breakdown predicts the device figures: an optimization that saves bytes
+ * shows up in uploadUs, one that saves refreshes in busyUs and settleUs.
+ *
+ * Controller starts (initialize(), wakeUp()) get a breakdown of their own,
+ * StartupTiming, filled by startController(): reset and boot, then the init
+ * table split into upload, BUSY and guard time.
+ */
+#include "EPDDisplay.h"
+
+void EPDDisplay::getFrameTiming(FrameTiming *timing)
+{
+    *timing = lastFrameTiming;
+}
+
+void EPDDisplay::setFrameTimingCallback(FrameTimingCallback callback, void *arg)
+{
+    frameTimingCallback = callback;
+    frameTimingCallbackArg = arg;
+}
+
+void EPDDisplay::getStartupTiming(StartupTiming *timing)
+{
+    *timing = startupTiming;
+}
+
+void EPDDisplay::setStartupTimingCallback(StartupTimingCallback callback, void *arg)
+{
+    startupTimingCallback = callback;
+    startupTimingCallbackArg = arg;
+}
+
+void EPDDisplay::setInitGuardTime(uint16_t ms)
+{
+    initGuardMs = ms;
+}
+
+void EPDDisplay::beginFrame()
+{
+    if (frameOpen)
+    {
+        return;
+    }
+    uint32_t now = transport->nowUs();
+    memset(&frameTiming, 0, sizeof(frameTiming));
+    frameTiming.renderUs = now - lastFrameEndUs;
+    frameStartUs = now;
+    frameOpen = true;
+}
+
+void EPDDisplay::endFrame()
+{
+    if (!frameOpen)
+    {
+        return;
+    }
+    uint32_t now = transport->nowUs();
+    frameTiming.totalUs = now - frameStartUs;
+    uint32_t waits = frameTiming.busyUs + frameTiming.settleUs;
+    frameTiming.uploadUs = (frameTiming.totalUs > waits) ? frameTiming.totalUs - waits : 0;
+    lastFrameTiming = frameTiming;
+    lastFrameEndUs = now;
+    frameOpen = false;
+
+    if (frameTimingCallback != NULL)
+    {
+        frameTimingCallback(this, &lastFrameTiming, frameTimingCallbackArg);
+    }
+}
+
+void EPDDisplay::Settle(uint32_t ms)
+{
+    uint32_t start = transport->nowUs();
+    transport->delayMs(ms);
+    frameTiming.settleUs += transport->nowUs() - start;
+}
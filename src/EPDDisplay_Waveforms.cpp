@@ -0,0 +1,152 @@
+/**
+ * @file EPDDisplay_Waveforms.cpp
+ * @brief Refresh modes: default waveform tables and waveform selection.
+ *
+ * A waveform describes how the controller is prepared for a refresh and
+ * which update sequence (0x22) starts it:
+ *   - lut / lutLength   optional custom LUT written with command 0x32
+ *   - temperature       optional override written to 0x1A, so that the
+ *                       OTP lookup picks a faster (high-temperature) waveform
+ *   - loadSequence      0x22 value that loads the LUT (0 = nothing to load)
+ *   - updateSequence    0x22 value used for the refresh itself
+ *
+ * 0x22 bits: 0x80 enable clock, 0x40 enable analog, 0x20 load temperature,
+ * 0x10 load LUT, 0x08 display mode 2, 0x04 display, 0x02 disable analog,
+ * 0x01 disable clock.
+ *
+ * The fast modes only drive black/white transitions. A frame whose red plane
+ * changed since the last upload is always refreshed with the full tricolor
+ * waveform. The default fast tables use the OTP waveforms at a forced
+ * temperature; panels that need their own timing take a custom LUT through
+ * setWaveform().
+ */
+#include "EPDDisplay.h"
+
+// Full tricolor refresh: OTP LUT at the measured temperature (as in hwInit())
+const EPDDisplay::Waveform EPDDisplay::WAVEFORM_FULL_TRICOLOR = {
+    NULL, // lut
+    0,    // lutLength
+    false,
+    0,    // temperature
+    0xB1, // load: clock + temperature + LUT
+    0xC7, // update: clock + analog + display + disable
+};
+
+// Black/white refresh with the OTP waveform for 90 °C: short phases, a few seconds
+const EPDDisplay::Waveform EPDDisplay::WAVEFORM_FAST_BW = {
+    NULL,
+    0,
+    true,
+    90,
+    0x91, // load: clock + LUT (keeps the forced temperature)
+    0xC7,
+};
+
+// Differential black/white refresh (display mode 2) with the 110 °C waveform
+const EPDDisplay::Waveform EPDDisplay::WAVEFORM_PARTIAL_BW = {
+    NULL,
+    0,
+    true,
+    110,
+    0x91,
+    0xCF, // update: clock + analog + display mode 2 + disable
+};
+
+const EPDDisplay::Waveform *EPDDisplay::defaultWaveform(REFRESH_MODE mode)
+{
+    switch (mode)
+    {
+    case EPDDisplay::REFRESH_FAST_BW:
+        return &WAVEFORM_FAST_BW;
+    case EPDDisplay::REFRESH_PARTIAL_BW:
+        return &WAVEFORM_PARTIAL_BW;
+    default:
+        return &WAVEFORM_FULL_TRICOLOR;
+    }
+}
+
+void EPDDisplay::setRefreshMode(REFRESH_MODE mode)
+{
+    if (mode == EPDDisplay::REFRESH_FULL_TRICOLOR || mode == EPDDisplay::REFRESH_FAST_BW ||
+        mode == EPDDisplay::REFRESH_PARTIAL_BW)
+    {
+        refreshMode = mode;
+    }
+    else
+    {
+        Debug("mode should be EPDDisplay::REFRESH_FULL_TRICOLOR, EPDDisplay::REFRESH_FAST_BW, EPDDisplay::REFRESH_PARTIAL_BW\r\n");
+    }
+}
+
+EPDDisplay::REFRESH_MODE EPDDisplay::getRefreshMode()
+{
+    return refreshMode;
+}
+
+EPDDisplay::REFRESH_MODE EPDDisplay::getLastRefreshMode()
+{
+    return lastRefreshMode;
+}
+
+bool EPDDisplay::setWaveform(REFRESH_MODE mode, const Waveform *waveform)
+{
+    if (mode > EPDDisplay::REFRESH_PARTIAL_BW)
+    {
+        Debug("Invalid refresh mode\r\n");
+        return false;
+    }
+    if (waveform != NULL && waveform->lut != NULL && waveform->lutLength > 0 &&
+        (waveform->loadSequence & 0x10))
+    {
+        // The OTP LUT would be loaded over the one just written with 0x32
+        Debug("setWaveform: a custom LUT needs a loadSequence without 0x10\r\n");
+        return false;
+    }
+    if (waveforms[mode] == loadedWaveform)
+    {
+        loadedWaveform = NULL; // Force a reload on next use
+    }
+    waveforms[mode] = (waveform != NULL) ? waveform : defaultWaveform(mode);
+    return true;
+}
+
+void EPDDisplay::LoadWaveform(REFRESH_MODE mode)
+{
+    const Waveform *waveform = waveforms[mode];
+    lastRefreshMode = mode;
+    activeUpdateSequence = waveform->updateSequence;
+    if (waveform == loadedWaveform)
+    {
+        return;
+    }
+
+    if (waveform->lut != NULL && waveform->lutLength > 0)
+    {
+        SendCommand(0x32); // Write LUT register
+        BeginData();
+        SendDataSpan(waveform->lut, waveform->lutLength, false);
+        EndData();
+    }
+
+    if (waveform->overrideTemperature)
+    {
+        // 12-bit temperature register, 1/16 °C resolution: integer part first
+        SendCommand(0x1A);
+        SendData((uint8_t)waveform->temperature);
+        SendData(0x00);
+    }
+    else
+    {
+        SendCommand(0x18); // Back to the internal temperature sensor
+        SendData(0x80);
+    }
+
+    if (waveform->loadSequence != 0)
+    {
+        SendCommand(0x22);
+        SendData(waveform->loadSequence);
+        SendCommand(0x20);
+        ReadBusy(); // Wait for the LUT load to complete
+    }
+    loadedWaveform = waveform;
+}
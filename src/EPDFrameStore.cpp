@@ -0,0 +1,121 @@
+/**
+ * @file EPDFrameStore.cpp
+ * @brief Built-in EPDFrameStore backends: RTC slow memory and NVS / host file.
+ *
+ * Both only move bytes; EPDDisplay validates what it loads (magic number and
+ * checksum), so a store never has to know the record layout.
+ */
+#include "EPDDisplay.h"
+
+#if defined(ESP32)
+#include <Preferences.h>
+#define EPD_NVS_NAMESPACE "epd"
+#endif
+
+#ifndef RTC_DATA_ATTR
+#define RTC_DATA_ATTR
+#endif
+
+// Zeroed on power-up, kept across deep sleep
+RTC_DATA_ATTR static uint8_t epdRtcRecord[EPD_RTC_STORE_SIZE];
+RTC_DATA_ATTR static uint32_t epdRtcRecordSize;
+
+bool EPDRtcFrameStore::load(void *data, uint32_t size)
+{
+    if (size == 0 || size != epdRtcRecordSize)
+    {
+        return false;
+    }
+    memcpy(data, epdRtcRecord, size);
+    return true;
+}
+
+bool EPDRtcFrameStore::save(const void *data, uint32_t size)
+{
+    if (size > EPD_RTC_STORE_SIZE)
+    {
+        Debug("Frame record too large for the RTC store\r\n");
+        return false;
+    }
+    memcpy(epdRtcRecord, data, size);
+    epdRtcRecordSize = size;
+    return true;
+}
+
+void EPDRtcFrameStore::erase()
+{
+    epdRtcRecordSize = 0;
+}
+
+EPDNvsFrameStore::EPDNvsFrameStore(const char *key) : m_key(key)
+{
+}
+
+bool EPDNvsFrameStore::load(void *data, uint32_t size)
+{
+#if defined(ESP32)
+    Preferences prefs;
+    if (!prefs.begin(EPD_NVS_NAMESPACE, true))
+    {
+        return false;
+    }
+    bool ok = prefs.getBytesLength(m_key) == size && prefs.getBytes(m_key, data, size) == size;
+    prefs.end();
+    return ok;
+#elif !defined(ARDUINO)
+    FILE *file = fopen(m_key, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    // Exactly size bytes: a shorter or longer file is a different record
+    bool ok = fread(data, 1, size, file) == size && fgetc(file) == EOF;
+    fclose(file);
+    return ok;
+#else
+    (void)data;
+    (void)size;
+    return false;
+#endif
+}
+
+bool EPDNvsFrameStore::save(const void *data, uint32_t size)
+{
+#if defined(ESP32)
+    Preferences prefs;
+    if (!prefs.begin(EPD_NVS_NAMESPACE, false))
+    {
+        return false;
+    }
+    bool ok = prefs.putBytes(m_key, data, size) == size;
+    prefs.end();
+    return ok;
+#elif !defined(ARDUINO)
+    FILE *file = fopen(m_key, "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool ok = fwrite(data, 1, size, file) == size;
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+#else
+    (void)data;
+    (void)size;
+    return false;
+#endif
+}
+
+void EPDNvsFrameStore::erase()
+{
+#if defined(ESP32)
+    Preferences prefs;
+    if (prefs.begin(EPD_NVS_NAMESPACE, false))
+    {
+        prefs.remove(m_key);
+        prefs.end();
+    }
+#elif !defined(ARDUINO)
+    remove(m_key);
+#endif
+}
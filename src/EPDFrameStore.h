@@ -0,0 +1,85 @@
+#ifndef __EPDFRAMESTORE_H
+#define __EPDFRAMESTORE_H
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include "EPDHostShim.h"
+#endif
+
+/**
+ * @brief Persistent storage for one small record that must survive MCU deep sleep
+ *
+ * EPDDisplay::setFrameStore() uses it to keep the fingerprint of the frame
+ * the panel shows (a few hundred bytes) across a deep sleep of the
+ * microcontroller, so that the first display() after waking can skip what
+ * did not change. Any storage works: implement load(), save() and erase().
+ */
+class EPDFrameStore
+{
+public:
+    virtual ~EPDFrameStore() {}
+
+    /**
+     * @brief Read the stored record
+     * @param data Destination
+     * @param size Expected record size in bytes
+     * @return false if there is no record of exactly this size
+     */
+    virtual bool load(void *data, uint32_t size) = 0;
+
+    /**
+     * @brief Replace the stored record
+     * @return false if it could not be written
+     */
+    virtual bool save(const void *data, uint32_t size) = 0;
+
+    /**
+     * @brief Remove the stored record (load() fails until the next save())
+     */
+    virtual void erase() = 0;
+};
+
+/**
+ * @brief Record kept in ESP32 RTC slow memory (RTC_DATA_ATTR)
+ * Survives deep sleep, not a power cycle or reset, and costs no flash
+ * writes. There is a single slot of EPD_RTC_STORE_SIZE bytes shared by all
+ * instances. On host builds the slot is a static buffer, so it survives
+ * destroying and recreating the display within one process; on other
+ * Arduino targets it is plain RAM.
+ */
+#define EPD_RTC_STORE_SIZE 1024
+
+class EPDRtcFrameStore : public EPDFrameStore
+{
+public:
+    bool load(void *data, uint32_t size);
+    bool save(const void *data, uint32_t size);
+    void erase();
+};
+
+/**
+ * @brief Record kept in flash (ESP32 NVS through Preferences)
+ * Survives power cycles. Each save() is one flash write, so prefer
+ * EPDRtcFrameStore when the board only deep-sleeps. On host builds the
+ * record is stored in a file named after the key; other Arduino targets
+ * have no NVS and never load a record.
+ */
+class EPDNvsFrameStore : public EPDFrameStore
+{
+public:
+    /**
+     * @brief Constructor
+     * @param key NVS key in the "epd" namespace (at most 15 characters), or
+     *            file path on host builds. The string must stay valid.
+     */
+    EPDNvsFrameStore(const char *key);
+
+    bool load(void *data, uint32_t size);
+    bool save(const void *data, uint32_t size);
+    void erase();
+
+private:
+    const char *m_key;
+};
+
+#endif // __EPDFRAMESTORE_H
@@ -0,0 +1,273 @@
+/**
+ * @file EPDHostShim.cpp
+ * @brief Host implementation of the Arduino subset declared in EPDHostShim.h.
+ *
+ * Compiles to an empty translation unit on Arduino targets.
+ */
+#ifndef ARDUINO
+
+#include "EPDHostShim.h"
+
+HostSerial Serial;
+
+static uint8_t s_pinLevel[EPD_HOST_MAX_PINS];
+static uint8_t s_inputLevel[EPD_HOST_MAX_PINS];
+static uint64_t s_nowMicros = 0;
+static uint32_t s_gpioWrites = 0;
+static uint32_t s_gpioTransitions = 0;
+
+static void (*s_isr[EPD_HOST_MAX_PINS])(void *);
+static void *s_isrArg[EPD_HOST_MAX_PINS];
+static int s_isrMode[EPD_HOST_MAX_PINS];
+
+// Emulated heap pools
+#define EPD_HOST_MAX_ALLOCS 64
+typedef struct
+{
+    void *ptr;
+    uint32_t size;
+    bool psram;
+} HostBlock;
+static HostBlock s_blocks[EPD_HOST_MAX_ALLOCS];
+static uint32_t s_psramSize = 0;
+static uint32_t s_psramUsed = 0;
+static uint32_t s_internalSize = 0xFFFFFFFF;
+static uint32_t s_internalUsed = 0;
+static EPDHost::AllocRecord s_allocLog[EPD_HOST_MAX_ALLOCS];
+static uint32_t s_allocCount = 0;
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    s_gpioWrites++;
+    if (pin < EPD_HOST_MAX_PINS)
+    {
+        uint8_t level = val ? HIGH : LOW;
+        if (s_pinLevel[pin] != level)
+        {
+            s_gpioTransitions++;
+        }
+        s_pinLevel[pin] = level;
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    // Inputs default to LOW, which the driver reads as "BUSY released"
+    return (pin < EPD_HOST_MAX_PINS) ? s_inputLevel[pin] : LOW;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode)
+{
+    if (pin < EPD_HOST_MAX_PINS)
+    {
+        s_isr[pin] = handler;
+        s_isrArg[pin] = arg;
+        s_isrMode[pin] = mode;
+    }
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    if (pin < EPD_HOST_MAX_PINS)
+    {
+        s_isr[pin] = NULL;
+    }
+}
+
+unsigned long millis()
+{
+    return (unsigned long)(s_nowMicros / 1000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)s_nowMicros;
+}
+
+void delay(uint32_t ms)
+{
+    s_nowMicros += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    s_nowMicros += us;
+}
+
+static HostBlock *findBlock(const void *ptr)
+{
+    for (int i = 0; i < EPD_HOST_MAX_ALLOCS; i++)
+    {
+        if (s_blocks[i].ptr != NULL && ptr >= s_blocks[i].ptr &&
+            (const uint8_t *)ptr < (const uint8_t *)s_blocks[i].ptr + s_blocks[i].size)
+        {
+            return &s_blocks[i];
+        }
+    }
+    return NULL;
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    // Like ESP-IDF: SPIRAM only when asked for, internal RAM when asked for
+    // INTERNAL or DMA, otherwise internal first, then PSRAM
+    bool wantPsram = (caps & MALLOC_CAP_SPIRAM) != 0;
+    bool wantInternal = (caps & (MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA)) != 0;
+    bool psram = false;
+    void *ptr = NULL;
+
+    int slot = -1;
+    for (int i = 0; i < EPD_HOST_MAX_ALLOCS && slot < 0; i++)
+    {
+        if (s_blocks[i].ptr == NULL)
+            slot = i;
+    }
+
+    if (slot >= 0 && !(wantPsram && wantInternal))
+    {
+        if (!wantPsram && s_internalUsed + size <= s_internalSize)
+        {
+            ptr = malloc(size);
+        }
+        else if (!wantInternal && s_psramUsed + size <= s_psramSize)
+        {
+            ptr = malloc(size);
+            psram = true;
+        }
+    }
+
+    if (ptr != NULL)
+    {
+        s_blocks[slot].ptr = ptr;
+        s_blocks[slot].size = (uint32_t)size;
+        s_blocks[slot].psram = psram;
+        if (psram)
+            s_psramUsed += size;
+        else
+            s_internalUsed += size;
+    }
+
+    if (s_allocCount < EPD_HOST_MAX_ALLOCS)
+    {
+        EPDHost::AllocRecord &record = s_allocLog[s_allocCount++];
+        record.size = (uint32_t)size;
+        record.caps = caps;
+        record.psram = psram;
+        record.ok = (ptr != NULL);
+    }
+    return ptr;
+}
+
+void heap_caps_free(void *ptr)
+{
+    HostBlock *block = findBlock(ptr);
+    if (block != NULL)
+    {
+        if (block->psram)
+            s_psramUsed -= block->size;
+        else
+            s_internalUsed -= block->size;
+        block->ptr = NULL;
+    }
+    free(ptr);
+}
+
+bool psramFound()
+{
+    return s_psramSize > 0;
+}
+
+bool esp_ptr_external_ram(const void *ptr)
+{
+    HostBlock *block = findBlock(ptr);
+    return block != NULL && block->psram;
+}
+
+bool esp_ptr_dma_capable(const void *ptr)
+{
+    // Everything outside the PSRAM pool counts as internal, DMA-capable RAM
+    return !esp_ptr_external_ram(ptr);
+}
+
+void EPDHost::setPsramSize(uint32_t bytes)
+{
+    s_psramSize = bytes;
+}
+
+void EPDHost::setInternalHeapSize(uint32_t bytes)
+{
+    s_internalSize = bytes;
+}
+
+uint32_t EPDHost::allocCount()
+{
+    return s_allocCount;
+}
+
+const EPDHost::AllocRecord &EPDHost::allocRecord(uint32_t index)
+{
+    return s_allocLog[index];
+}
+
+void EPDHost::setInputLevel(uint8_t pin, uint8_t level)
+{
+    if (pin >= EPD_HOST_MAX_PINS)
+    {
+        return;
+    }
+    uint8_t previous = s_inputLevel[pin];
+    s_inputLevel[pin] = level ? HIGH : LOW;
+
+    if (s_isr[pin] != NULL && previous != s_inputLevel[pin])
+    {
+        int edge = s_inputLevel[pin] ? RISING : FALLING;
+        if (s_isrMode[pin] == CHANGE || s_isrMode[pin] == edge)
+        {
+            s_isr[pin](s_isrArg[pin]);
+        }
+    }
+}
+
+uint8_t EPDHost::pinLevel(uint8_t pin)
+{
+    return (pin < EPD_HOST_MAX_PINS) ? s_pinLevel[pin] : LOW;
+}
+
+uint32_t EPDHost::gpioWriteCount()
+{
+    return s_gpioWrites;
+}
+
+uint32_t EPDHost::gpioTransitionCount()
+{
+    return s_gpioTransitions;
+}
+
+void EPDHost::resetGpioCounters()
+{
+    s_gpioWrites = 0;
+    s_gpioTransitions = 0;
+}
+
+void EPDHost::advanceMicros(uint32_t us)
+{
+    s_nowMicros += us;
+}
+
+void EPDHost::reset()
+{
+    memset(s_pinLevel, 0, sizeof(s_pinLevel));
+    memset(s_inputLevel, 0, sizeof(s_inputLevel));
+    memset(s_isr, 0, sizeof(s_isr));
+    s_nowMicros = 0;
+    s_allocCount = 0;
+    resetGpioCounters();
+}
+
+#endif // ARDUINO
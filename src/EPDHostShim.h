@@ -0,0 +1,171 @@
+/**
+ * @file EPDHostShim.h
+ * @brief Minimal Arduino API stand-in used when the library is compiled on a
+ *        host (Linux/macOS) instead of an Arduino board.
+ *
+ * Only the subset of the Arduino core that the library actually touches is
+ * provided: fixed-width integer types, GPIO (pinMode / digitalWrite /
+ * digitalRead), pin interrupts, timing (millis / micros / delay), the
+ * ESP-IDF heap_caps allocator and a Serial object for the Debug() macro.
+ *
+ * Time is virtual: delay() advances a counter instead of sleeping, so a full
+ * init + display() cycle runs in microseconds on the host. GPIO writes are
+ * latched in a pin table so that host code can inspect pin levels, and
+ * counted (calls and actual level transitions) so that the cost of a
+ * transport can be measured per frame.
+ *
+ * heap_caps_malloc() models the ESP32 memory map with two pools, internal
+ * (DMA-capable) RAM and optional PSRAM, each with a configurable size. Every
+ * request is logged with its capabilities and outcome, so allocation
+ * policies can be checked on the host.
+ *
+ * This header is only included when ARDUINO is not defined (see EPDDisplay.h).
+ */
+#ifndef __EPDHOSTSHIM_H
+#define __EPDHOSTSHIM_H
+
+#ifndef ARDUINO
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define IRAM_ATTR
+
+#define EPD_HOST_MAX_PINS 64
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+#define digitalPinToInterrupt(p) (p)
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// ESP-IDF heap capability flags (same values as esp_heap_caps.h)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+void *heap_caps_malloc(size_t size, uint32_t caps);
+void heap_caps_free(void *ptr);
+bool psramFound();
+bool esp_ptr_external_ram(const void *ptr);
+bool esp_ptr_dma_capable(const void *ptr);
+
+/**
+ * @brief Host-side control over the shimmed GPIO and clock
+ */
+namespace EPDHost
+{
+    /**
+     * @brief Drive the level that digitalRead() returns for an input pin
+     * (e.g. to simulate the panel holding BUSY high). A level change runs the
+     * handler registered with attachInterruptArg() if its mode matches.
+     */
+    void setInputLevel(uint8_t pin, uint8_t level);
+
+    /**
+     * @brief Last level written to a pin with digitalWrite()
+     */
+    uint8_t pinLevel(uint8_t pin);
+
+    /**
+     * @brief Number of digitalWrite() calls since the last resetGpioCounters()
+     */
+    uint32_t gpioWriteCount();
+
+    /**
+     * @brief Number of digitalWrite() calls that changed a pin level
+     */
+    uint32_t gpioTransitionCount();
+
+    /**
+     * @brief Zero both GPIO counters
+     */
+    void resetGpioCounters();
+
+    /**
+     * @brief Advance the virtual clock without calling delay()
+     */
+    void advanceMicros(uint32_t us);
+
+    /**
+     * @brief One heap_caps_malloc() request
+     */
+    typedef struct
+    {
+        uint32_t size;
+        uint32_t caps; // Requested MALLOC_CAP_* flags
+        bool psram;    // Served from PSRAM (only meaningful if ok)
+        bool ok;       // false if no pool could satisfy the request
+    } AllocRecord;
+
+    /**
+     * @brief Size of the emulated PSRAM pool (0 = board without PSRAM, the default)
+     */
+    void setPsramSize(uint32_t bytes);
+
+    /**
+     * @brief Size of the emulated internal RAM pool (default: unlimited)
+     */
+    void setInternalHeapSize(uint32_t bytes);
+
+    /**
+     * @brief Number of heap_caps_malloc() requests logged since the last reset()
+     */
+    uint32_t allocCount();
+
+    /**
+     * @brief Logged heap_caps_malloc() request at index (0 = oldest)
+     */
+    const AllocRecord &allocRecord(uint32_t index);
+
+    /**
+     * @brief Reset pin levels, GPIO counters, the virtual clock and the
+     * allocation log to zero (pool sizes are kept)
+     */
+    void reset();
+}
+
+/**
+ * @brief Serial stand-in that prints to stdout (used by the Debug() macro)
+ */
+class HostSerial
+{
+public:
+    void begin(unsigned long) {}
+    void print(const char *s) { fputs(s, stdout); }
+    void print(int v) { printf("%d", v); }
+    void print(unsigned int v) { printf("%u", v); }
+    void print(long v) { printf("%ld", v); }
+    void print(unsigned long v) { printf("%lu", v); }
+    void print(double v) { printf("%.2f", v); }
+    void println(const char *s) { puts(s); }
+};
+
+extern HostSerial Serial;
+
+#endif // ARDUINO
+
+#endif // __EPDHOSTSHIM_H
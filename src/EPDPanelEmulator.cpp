@@ -0,0 +1,375 @@
+/**
+ * @file EPDPanelEmulator.cpp
+ * @brief Controller model behind EPDPanelEmulator (see EPDPanelEmulator.h).
+ *
+ * RAM is kept as two planes of 110 × 1024 bytes in controller layout: RAM X
+ * byte (pixel X / 8) by RAM Y, covering every Y address (the driver puts the
+ * 528 panel rows at RAM rows 687 down to 160). The address counters move exactly like the
+ * controller's: one data byte = 8 pixels along X, the data entry mode picks
+ * the direction of each axis and which one advances first, and a counter
+ * that leaves the window wraps to the window start and steps the other axis.
+ *
+ * On activation the planes are copied into display row order (top row
+ * first, according to the scan direction of 0x01), which is what pixel(),
+ * diffPixels() and the PPM dump read.
+ */
+#include "EPDPanelEmulator.h"
+
+#define EMU_WIDTH_BYTE (EPD_7IN5B_HD_WIDTH / 8)
+#define EMU_HEIGHT EPD_7IN5B_HD_HEIGHT
+#define EMU_RAM_ROWS 1024 // Every 10-bit Y address
+#define EMU_RAM_SIZE ((uint32_t)EMU_WIDTH_BYTE * EMU_RAM_ROWS)
+#define EMU_PLANE_SIZE ((uint32_t)EMU_WIDTH_BYTE * EMU_HEIGHT)
+
+EPDPanelEmulator::EPDPanelEmulator()
+    : m_sleeping(false),
+      m_frames(0),
+      m_ignored(0),
+      m_dumpPrefix(NULL)
+{
+    for (int p = 0; p < 2; p++)
+    {
+        m_ram[p] = (uint8_t *)malloc(EMU_RAM_SIZE);
+        m_visible[p] = (uint8_t *)malloc(EMU_PLANE_SIZE);
+        if (m_ram[p] != NULL)
+        {
+            memset(m_ram[p], 0, EMU_RAM_SIZE);
+        }
+    }
+    // Nothing shown yet: white
+    if (m_visible[0] != NULL)
+    {
+        memset(m_visible[0], 0xFF, EMU_PLANE_SIZE);
+    }
+    if (m_visible[1] != NULL)
+    {
+        memset(m_visible[1], 0x00, EMU_PLANE_SIZE);
+    }
+    resetRegisters();
+}
+
+EPDPanelEmulator::~EPDPanelEmulator()
+{
+    for (int p = 0; p < 2; p++)
+    {
+        free(m_ram[p]);
+        free(m_visible[p]);
+        m_ram[p] = NULL;
+        m_visible[p] = NULL;
+    }
+}
+
+void EPDPanelEmulator::resetRegisters()
+{
+    m_xStart = 0;
+    m_xEnd = EPD_7IN5B_HD_WIDTH - 1;
+    m_yStart = 0;
+    m_yEnd = EMU_RAM_ROWS - 1;
+    m_x = 0;
+    m_y = 0;
+    m_entryMode = 0x03; // X and Y increment, X first
+    m_gates = EMU_HEIGHT;
+    m_scanReverse = false;
+    m_sequence = 0;
+    m_command = 0;
+    m_paramCount = 0;
+}
+
+void EPDPanelEmulator::reset(uint32_t low_ms, uint32_t settle_ms)
+{
+    EPDMockTransport::reset(low_ms, settle_ms);
+    // A hardware reset leaves deep sleep; RAM content is kept
+    m_sleeping = false;
+    resetRegisters();
+}
+
+void EPDPanelEmulator::writeCommand(uint8_t command)
+{
+    EPDMockTransport::writeCommand(command);
+    if (m_sleeping)
+    {
+        m_ignored++;
+        return;
+    }
+
+    m_command = command;
+    m_paramCount = 0;
+    switch (command)
+    {
+    case 0x12: // SWRESET
+        resetRegisters();
+        break;
+    case 0x20: // Master activation
+        if (m_sequence & 0x04)
+        {
+            latch();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void EPDPanelEmulator::writeData(uint8_t data)
+{
+    EPDMockTransport::writeData(data);
+    if (m_sleeping)
+    {
+        m_ignored++;
+        return;
+    }
+
+    if (m_command == 0x24 || m_command == 0x26)
+    {
+        writeRam(m_command == 0x24 ? 0 : 1, data);
+        return;
+    }
+
+    if (m_paramCount < sizeof(m_param))
+    {
+        m_param[m_paramCount] = data;
+    }
+    m_paramCount++;
+
+    switch (m_command)
+    {
+    case 0x01: // Driver output control: MUX (2 bytes), gate scan bits
+        if (m_paramCount == 2)
+        {
+            m_gates = (uint16_t)((m_param[0] | (m_param[1] << 8)) & 0x03FF) + 1;
+        }
+        else if (m_paramCount == 3)
+        {
+            m_scanReverse = (data & 0x01) != 0;
+        }
+        break;
+    case 0x10: // Deep sleep mode
+        m_sleeping = (data & 0x03) != 0;
+        break;
+    case 0x11: // Data entry mode
+        m_entryMode = data & 0x07;
+        break;
+    case 0x22: // Display update sequence
+        m_sequence = data;
+        break;
+    case 0x44: // RAM X window: start, end (pixels)
+        if (m_paramCount == 4)
+        {
+            m_xStart = (uint16_t)((m_param[0] | (m_param[1] << 8)) & 0x03FF);
+            m_xEnd = (uint16_t)((m_param[2] | (m_param[3] << 8)) & 0x03FF);
+        }
+        break;
+    case 0x45: // RAM Y window: start, end
+        if (m_paramCount == 4)
+        {
+            m_yStart = (uint16_t)((m_param[0] | (m_param[1] << 8)) & 0x03FF);
+            m_yEnd = (uint16_t)((m_param[2] | (m_param[3] << 8)) & 0x03FF);
+        }
+        break;
+    case 0x4E: // RAM X counter
+        if (m_paramCount == 2)
+        {
+            m_x = (uint16_t)((m_param[0] | (m_param[1] << 8)) & 0x03FF);
+        }
+        break;
+    case 0x4F: // RAM Y counter
+        if (m_paramCount == 2)
+        {
+            m_y = (uint16_t)((m_param[0] | (m_param[1] << 8)) & 0x03FF);
+        }
+        break;
+    case 0x46: // Auto write red RAM
+    case 0x47: // Auto write BW RAM
+        if (m_paramCount == 1)
+        {
+            // Bit 7 is the value of the first step; the driver only uses
+            // full-size steps (0xF7 / 0x77), i.e. a solid fill
+            fillRam(m_command == 0x47 ? 0 : 1, (data & 0x80) ? 0xFF : 0x00);
+        }
+        break;
+    default:
+        // Booster, border, temperature, LUT...: no effect on the image
+        break;
+    }
+}
+
+// Move one counter toward the window end; returns true when it wrapped
+static bool stepCounter(uint16_t *pos, uint16_t start, uint16_t end, bool increment, uint16_t unit)
+{
+    if (increment)
+    {
+        if (*pos + unit > end)
+        {
+            *pos = start;
+            return true;
+        }
+        *pos += unit;
+    }
+    else
+    {
+        if (*pos < end + unit)
+        {
+            *pos = start;
+            return true;
+        }
+        *pos -= unit;
+    }
+    return false;
+}
+
+void EPDPanelEmulator::writeRam(uint8_t plane, uint8_t value)
+{
+    uint16_t xByte = m_x / 8;
+    if (m_ram[plane] != NULL && xByte < EMU_WIDTH_BYTE && m_y < EMU_RAM_ROWS)
+    {
+        m_ram[plane][(uint32_t)m_y * EMU_WIDTH_BYTE + xByte] = value;
+    }
+    else
+    {
+        m_ignored++;
+    }
+
+    bool xIncrement = (m_entryMode & 0x01) != 0;
+    bool yIncrement = (m_entryMode & 0x02) != 0;
+    if ((m_entryMode & 0x04) == 0)
+    {
+        if (stepCounter(&m_x, m_xStart, m_xEnd, xIncrement, 8))
+        {
+            stepCounter(&m_y, m_yStart, m_yEnd, yIncrement, 1);
+        }
+    }
+    else
+    {
+        if (stepCounter(&m_y, m_yStart, m_yEnd, yIncrement, 1))
+        {
+            stepCounter(&m_x, m_xStart, m_xEnd, xIncrement, 8);
+        }
+    }
+}
+
+void EPDPanelEmulator::fillRam(uint8_t plane, uint8_t value)
+{
+    if (m_ram[plane] == NULL)
+    {
+        return;
+    }
+    uint16_t x0 = ((m_xStart < m_xEnd) ? m_xStart : m_xEnd) / 8;
+    uint16_t x1 = ((m_xStart < m_xEnd) ? m_xEnd : m_xStart) / 8;
+    uint16_t y0 = (m_yStart < m_yEnd) ? m_yStart : m_yEnd;
+    uint16_t y1 = (m_yStart < m_yEnd) ? m_yEnd : m_yStart;
+    if (x1 >= EMU_WIDTH_BYTE)
+    {
+        x1 = EMU_WIDTH_BYTE - 1;
+    }
+    if (y1 >= EMU_RAM_ROWS)
+    {
+        y1 = EMU_RAM_ROWS - 1;
+    }
+    for (uint16_t y = y0; y <= y1 && x0 <= x1; y++)
+    {
+        memset(&m_ram[plane][(uint32_t)y * EMU_WIDTH_BYTE + x0], value, x1 - x0 + 1);
+    }
+}
+
+void EPDPanelEmulator::latch()
+{
+    if (m_ram[0] == NULL || m_ram[1] == NULL || m_visible[0] == NULL || m_visible[1] == NULL)
+    {
+        return;
+    }
+    for (uint16_t row = 0; row < EMU_HEIGHT; row++)
+    {
+        uint32_t dst = (uint32_t)row * EMU_WIDTH_BYTE;
+        if (row >= m_gates)
+        {
+            // No gate line drives this row: stays white
+            memset(&m_visible[0][dst], 0xFF, EMU_WIDTH_BYTE);
+            memset(&m_visible[1][dst], 0x00, EMU_WIDTH_BYTE);
+            continue;
+        }
+        uint32_t src = (uint32_t)(m_scanReverse ? m_gates - 1 - row : row) * EMU_WIDTH_BYTE;
+        memcpy(&m_visible[0][dst], &m_ram[0][src], EMU_WIDTH_BYTE);
+        memcpy(&m_visible[1][dst], &m_ram[1][src], EMU_WIDTH_BYTE);
+    }
+    m_frames++;
+
+#ifndef ARDUINO
+    if (m_dumpPrefix != NULL)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "%s_%04u.ppm", m_dumpPrefix, (unsigned)m_frames);
+        if (!writePpm(path))
+        {
+            Debug("EPDPanelEmulator: cannot write PPM\r\n");
+        }
+    }
+#endif
+}
+
+EPDDisplay::COLOR EPDPanelEmulator::pixel(uint16_t x, uint16_t y) const
+{
+    if (x >= EPD_7IN5B_HD_WIDTH || y >= EMU_HEIGHT || m_visible[0] == NULL || m_visible[1] == NULL)
+    {
+        return EPDDisplay::WHITE;
+    }
+    uint32_t addr = (uint32_t)y * EMU_WIDTH_BYTE + x / 8;
+    uint8_t bit = 0x80 >> (x % 8);
+    if (m_visible[1][addr] & bit)
+    {
+        return EPDDisplay::RED; // Red RAM bit 1 = red, drawn over BW
+    }
+    return (m_visible[0][addr] & bit) ? EPDDisplay::WHITE : EPDDisplay::BLACK;
+}
+
+uint32_t EPDPanelEmulator::diffPixels(const EPDPanelEmulator &other) const
+{
+    uint32_t diff = 0;
+    for (uint16_t y = 0; y < EMU_HEIGHT; y++)
+    {
+        for (uint16_t x = 0; x < EPD_7IN5B_HD_WIDTH; x++)
+        {
+            if (pixel(x, y) != other.pixel(x, y))
+            {
+                diff++;
+            }
+        }
+    }
+    return diff;
+}
+
+uint8_t EPDPanelEmulator::ramByte(uint8_t plane, uint16_t xByte, uint16_t y) const
+{
+    if (plane > 1 || xByte >= EMU_WIDTH_BYTE || y >= EMU_RAM_ROWS || m_ram[plane] == NULL)
+    {
+        return 0;
+    }
+    return m_ram[plane][(uint32_t)y * EMU_WIDTH_BYTE + xByte];
+}
+
+bool EPDPanelEmulator::writePpm(const char *path) const
+{
+#ifndef ARDUINO
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", EPD_7IN5B_HD_WIDTH, EMU_HEIGHT);
+    uint8_t line[EPD_7IN5B_HD_WIDTH * 3];
+    for (uint16_t y = 0; y < EMU_HEIGHT; y++)
+    {
+        for (uint16_t x = 0; x < EPD_7IN5B_HD_WIDTH; x++)
+        {
+            EPDDisplay::COLOR c = pixel(x, y);
+            line[x * 3] = (c == EPDDisplay::BLACK) ? 0 : 255;
+            line[x * 3 + 1] = (c == EPDDisplay::WHITE) ? 255 : 0;
+            line[x * 3 + 2] = (c == EPDDisplay::WHITE) ? 255 : 0;
+        }
+        fwrite(line, 1, sizeof(line), f);
+    }
+    return fclose(f) == 0;
+#else
+    (void)path;
+    return false;
+#endif
+}
@@ -0,0 +1,139 @@
+#ifndef __EPDPANELEMULATOR_H
+#define __EPDPANELEMULATOR_H
+#include "EPDDisplay.h"
+
+/**
+ * @file EPDPanelEmulator.h
+ * @brief Software model of the panel controller, for host regression tests.
+ *
+ * EPDPanelEmulator is a recording transport (it derives from
+ * EPDMockTransport, so the byte log, timestamps and BUSY simulation are all
+ * still there) that also interprets the command stream the way the
+ * controller does and keeps a model of its two RAM planes:
+ *
+ *   0x12        software reset: registers back to their defaults
+ *   0x01        driver output control: gate count and scan direction
+ *   0x11        data entry mode: X/Y increment or decrement, X or Y first
+ *   0x44 / 0x45 RAM X / Y window
+ *   0x4E / 0x4F RAM X / Y address counters
+ *   0x24 / 0x26 write BW / red RAM at the counters, wrapping inside the window
+ *   0x46 / 0x47 auto write red / BW RAM with the first-step value of the pattern
+ *   0x22 / 0x20 update sequence and activation: a sequence with the display
+ *               bit (0x04) latches the RAM into the visible image
+ *   0x10        deep sleep: further bytes are ignored until a hardware reset
+ *
+ * Other commands (booster, border, temperature, LUT) are logged but have no
+ * effect on the image. X addresses are in pixels, as this driver sends them;
+ * each data byte covers 8 pixels, MSB first. With the scan bit of 0x01 set,
+ * RAM row MUX (0x2AF = 687 with EPDDisplay's settings) is the top display
+ * row and the rows below it follow with decreasing addresses.
+ *
+ * The visible image can be compared between two emulators (diffPixels()),
+ * so a windowed, skipped or auto-written upload can be proven identical to
+ * a full one, and dumped as a binary PPM after every activation.
+ *
+ * Usage:
+ *   EPDPanelEmulator panel;
+ *   panel.setDumpPrefix("frame");   // frame_0001.ppm, frame_0002.ppm, ...
+ *   EPDDisplay display(&panel);
+ *   display.initialize();
+ */
+class EPDPanelEmulator : public EPDMockTransport
+{
+public:
+    EPDPanelEmulator();
+
+    /**
+     * @brief Destructor - frees the RAM model
+     */
+    ~EPDPanelEmulator();
+
+    void writeCommand(uint8_t command);
+    void writeData(uint8_t data);
+    void reset(uint32_t low_ms, uint32_t settle_ms);
+
+    /**
+     * @brief Write every displayed frame to "<prefix>_NNNN.ppm" (NULL = off, the default)
+     * The prefix string must stay valid while dumping is enabled. Host builds only.
+     */
+    void setDumpPrefix(const char *prefix) { m_dumpPrefix = prefix; }
+
+    /**
+     * @brief Number of activations that updated the visible image
+     */
+    uint32_t frameCount() const { return m_frames; }
+
+    /**
+     * @brief Color of a visible pixel (0,0 = top left)
+     * @return EPDDisplay::WHITE, EPDDisplay::BLACK or EPDDisplay::RED
+     */
+    EPDDisplay::COLOR pixel(uint16_t x, uint16_t y) const;
+
+    /**
+     * @brief Number of visible pixels that differ from another emulator's
+     */
+    uint32_t diffPixels(const EPDPanelEmulator &other) const;
+
+    /**
+     * @brief Raw controller RAM byte
+     * @param plane 0 = BW RAM (0x24), 1 = red RAM (0x26)
+     * @param xByte RAM X address / 8
+     * @param y RAM Y address
+     */
+    uint8_t ramByte(uint8_t plane, uint16_t xByte, uint16_t y) const;
+
+    /**
+     * @brief Bytes that had no effect because they were sent in deep sleep
+     * or addressed RAM beyond X = 879
+     */
+    uint32_t ignoredBytes() const { return m_ignored; }
+
+    /**
+     * @brief Write the visible image as a binary PPM (P6)
+     * @return false if the file could not be written (always false on Arduino)
+     */
+    bool writePpm(const char *path) const;
+
+private:
+    uint8_t *m_ram[2];     // BW / red RAM, widthByte × 1024 rows
+    uint8_t *m_visible[2]; // RAM latched by the last display activation
+    uint16_t m_xStart;     // RAM window and counters (X in pixels)
+    uint16_t m_xEnd;
+    uint16_t m_yStart;
+    uint16_t m_yEnd;
+    uint16_t m_x;
+    uint16_t m_y;
+    uint8_t m_entryMode;  // 0x11 value
+    uint16_t m_gates;     // MUX + 1 from 0x01
+    bool m_scanReverse;   // 0x01 TB bit: RAM row gates-1 at the top
+    uint8_t m_sequence;   // Last 0x22 value
+    uint8_t m_command;    // Command the following data bytes belong to
+    uint8_t m_param[4];
+    uint8_t m_paramCount;
+    bool m_sleeping;
+    uint32_t m_frames;
+    uint32_t m_ignored;
+    const char *m_dumpPrefix;
+
+    /**
+     * @brief Register values after power-on / software reset
+     */
+    void resetRegisters();
+
+    /**
+     * @brief Store one RAM byte at the counters and advance them
+     */
+    void writeRam(uint8_t plane, uint8_t value);
+
+    /**
+     * @brief Fill the RAM window of one plane (auto write)
+     */
+    void fillRam(uint8_t plane, uint8_t value);
+
+    /**
+     * @brief Copy RAM into the visible image (display activation)
+     */
+    void latch();
+};
+
+#endif // __EPDPANELEMULATOR_H
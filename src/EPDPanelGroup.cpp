@@ -0,0 +1,213 @@
+/**
+ * @file EPDPanelGroup.cpp
+ * @brief Panels on a shared SPI link with overlapped refreshes (see EPDPanelGroup.h).
+ *
+ * Each panel gets its own transport on the shared pins; only its CS (and
+ * BUSY) differ. Transfers are never concurrent: every call runs to
+ * completion and releases CS before the next one starts, so the panels only
+ * overlap in their BUSY periods, never on the wire.
+ *
+ * CS isolation: a panel whose CS floats low would take part in another
+ * panel's traffic, so initialize() drives every CS high before the first
+ * byte, not only when its own transport starts.
+ *
+ * Shared RST: EPDDisplay::reset() of a panel without its own RST only waits
+ * for the controller. The group pulses the shared line itself, once for all
+ * panels, in initialize() and wakeUp().
+ *
+ * The group's own waits and the reset pulse go through the first panel's
+ * transport (nowMs(), delayMs(), reset()), so an injected clock or a host
+ * latency model sees them like the panels' own waits.
+ */
+#include "EPDPanelGroup.h"
+
+EPDPanelGroup::EPDPanelGroup(int clk_pin, int din_pin, int dc_pin, int rst_pin, EPDDisplay::TRANSPORT transport)
+    : m_count(0),
+      m_CLK_pin(clk_pin),
+      m_DIN_pin(din_pin),
+      m_DC_pin(dc_pin),
+      m_RST_pin(rst_pin),
+      m_transport(transport)
+{
+}
+
+EPDPanelGroup::~EPDPanelGroup()
+{
+    // Reverse order: with DMA transports the first panel owns the SPI bus
+    while (m_count > 0)
+    {
+        m_count--;
+        delete m_panels[m_count];
+        m_panels[m_count] = NULL;
+    }
+}
+
+EPDDisplay *EPDPanelGroup::addPanel(int cs_pin, int busy_pin, int dc_pin, int rst_pin)
+{
+    if (m_count == EPD_GROUP_MAX_PANELS)
+    {
+        Debug("Panel group is full\r\n");
+        return NULL;
+    }
+    int dc = (dc_pin >= 0) ? dc_pin : m_DC_pin;
+    if (dc < 0)
+    {
+        Debug("addPanel: no DC pin (none shared, none given)\r\n");
+        return NULL;
+    }
+
+    // rst_pin -1: the group pulses the shared line, the panel only waits
+    EPDDisplay *display = new EPDDisplay(busy_pin, rst_pin, dc, cs_pin, m_CLK_pin, m_DIN_pin, m_transport);
+    m_panels[m_count] = display;
+    m_CS_pins[m_count] = cs_pin;
+    m_count++;
+    return display;
+}
+
+EPDDisplay *EPDPanelGroup::addPanel(EPDTransport *transport)
+{
+    if (m_count == EPD_GROUP_MAX_PANELS)
+    {
+        Debug("Panel group is full\r\n");
+        return NULL;
+    }
+    EPDDisplay *display = new EPDDisplay(transport);
+    m_panels[m_count] = display;
+    m_CS_pins[m_count] = -1;
+    m_count++;
+    return display;
+}
+
+EPDDisplay *EPDPanelGroup::panel(uint8_t index)
+{
+    return (index < m_count) ? m_panels[index] : NULL;
+}
+
+bool EPDPanelGroup::initialize()
+{
+    uint8_t i;
+    for (i = 0; i < m_count; i++)
+    {
+        if (m_CS_pins[i] >= 0)
+        {
+            pinMode(m_CS_pins[i], OUTPUT);
+            digitalWrite(m_CS_pins[i], HIGH);
+        }
+    }
+    pulseReset();
+
+    bool ok = true;
+    for (i = 0; i < m_count; i++)
+    {
+        if (!m_panels[i]->initialize())
+        {
+            Debug("Panel group: a panel failed to initialize\r\n");
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void EPDPanelGroup::display()
+{
+    // Like EPDDisplay::display(): let refreshes in flight finish first
+    waitRefresh();
+    displayAsync();
+    waitRefresh();
+}
+
+bool EPDPanelGroup::displayAsync()
+{
+    bool ok = true;
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+        // Returns right after the activation: the next upload overlaps this refresh
+        if (!m_panels[i]->displayAsync())
+        {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool EPDPanelGroup::isRefreshing()
+{
+    bool refreshing = false;
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+        // Polled on every panel so each one completes (and runs its callback)
+        if (m_panels[i]->isRefreshing())
+        {
+            refreshing = true;
+        }
+    }
+    return refreshing;
+}
+
+bool EPDPanelGroup::waitRefresh(uint32_t timeout_ms)
+{
+    if (m_count == 0)
+    {
+        return true;
+    }
+    uint32_t start = link()->nowMs();
+    while (isRefreshing())
+    {
+        if (link()->nowMs() - start >= timeout_ms)
+        {
+            return false;
+        }
+        link()->delayMs(1); // Yields to other FreeRTOS tasks
+    }
+    return true;
+}
+
+void EPDPanelGroup::sleep()
+{
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+        m_panels[i]->sleep();
+    }
+}
+
+void EPDPanelGroup::wakeUp()
+{
+    uint8_t i;
+    if (m_RST_pin >= 0)
+    {
+        // The pulse resets every controller on the line, asleep or not
+        for (i = 0; i < m_count; i++)
+        {
+            if (!m_panels[i]->isInSleep())
+            {
+                m_panels[i]->sleep();
+            }
+        }
+        pulseReset();
+    }
+    for (i = 0; i < m_count; i++)
+    {
+        m_panels[i]->wakeUp();
+    }
+}
+
+void EPDPanelGroup::pulseReset()
+{
+    if (m_RST_pin < 0 || m_count == 0)
+    {
+        return;
+    }
+    // The shared line belongs to no panel: lend it to the first panel's
+    // transport for the pulse, then give that transport its own pins back
+    EPDTransport *transport = link();
+    int busy = transport->busyPin();
+    int rst = transport->resetPin();
+    transport->setControlPins(busy, m_RST_pin);
+    transport->reset(2, 0);
+    transport->setControlPins(busy, rst);
+}
+
+EPDTransport *EPDPanelGroup::link()
+{
+    return m_panels[0]->transport;
+}
@@ -0,0 +1,145 @@
+#ifndef __EPDPANELGROUP_H
+#define __EPDPANELGROUP_H
+#include "EPDDisplay.h"
+
+// Panels one group can drive
+#define EPD_GROUP_MAX_PANELS 8
+
+/**
+ * @file EPDPanelGroup.h
+ * @brief Several panels on one SPI link, refreshed in parallel.
+ *
+ * The panels share CLK and DIN, and optionally DC and RST; each one has its
+ * own CS and BUSY. Every panel is an ordinary EPDDisplay (drawing, refresh
+ * modes, double buffering all work per panel), created and owned by the
+ * group.
+ *
+ * A refresh occupies only the panel's own controller: the link is idle
+ * while BUSY is high. display() therefore uploads to panel A, starts its
+ * refresh, uploads to panel B while A refreshes, and so on, then waits for
+ * all of them. N panels update in one refresh period plus N uploads instead
+ * of N refresh periods.
+ *
+ * Usage:
+ *   EPDPanelGroup group(CLK, DIN, DC, RST);
+ *   EPDDisplay *left = group.addPanel(CS_LEFT, BUSY_LEFT);
+ *   EPDDisplay *right = group.addPanel(CS_RIGHT, BUSY_RIGHT);
+ *   group.initialize();
+ *   left->drawString(...);
+ *   right->drawString(...);
+ *   group.display();
+ */
+class EPDPanelGroup
+{
+public:
+    /**
+     * @brief Constructor with the shared pins
+     * @param clk_pin Shared CLK signal pin (SCK)
+     * @param din_pin Shared DIN signal pin (MOSI)
+     * @param dc_pin Shared DC signal pin, -1 if every panel has its own
+     * @param rst_pin Shared RST signal pin, -1 if every panel has its own
+     * @param transport SPI backend of every panel (EPDDisplay::TRANSPORT_BITBANG,
+     *                  EPDDisplay::TRANSPORT_VSPI_DMA, EPDDisplay::TRANSPORT_HSPI_DMA);
+     *                  the DMA backends put all panels on one SPI peripheral
+     */
+    EPDPanelGroup(int clk_pin, int din_pin, int dc_pin = -1, int rst_pin = -1,
+                  EPDDisplay::TRANSPORT transport = EPDDisplay::TRANSPORT_BITBANG);
+
+    /**
+     * @brief Destructor - deletes the panels (last added first)
+     */
+    ~EPDPanelGroup();
+
+    /**
+     * @brief Add a panel on the shared link
+     * @param cs_pin CS signal pin of this panel
+     * @param busy_pin BUSY signal pin of this panel
+     * @param dc_pin DC signal pin of this panel, -1 to use the shared one
+     * @param rst_pin RST signal pin of this panel, -1 to use the shared one
+     * @return The panel, or NULL if the group is full or no DC pin is known
+     */
+    EPDDisplay *addPanel(int cs_pin, int busy_pin, int dc_pin = -1, int rst_pin = -1);
+
+    /**
+     * @brief Add a panel reached through a caller-provided transport
+     * The transport drives its own CS and BUSY (e.g. an EPDMockTransport on an
+     * EPDMockBus in host tests) and must stay valid while the group exists.
+     * @return The panel, or NULL if the group is full
+     */
+    EPDDisplay *addPanel(EPDTransport *transport);
+
+    /**
+     * @brief Number of panels added
+     */
+    uint8_t panelCount() const { return m_count; }
+
+    /**
+     * @brief Panel by index, in the order added (NULL if out of range)
+     */
+    EPDDisplay *panel(uint8_t index);
+
+    /**
+     * @brief Release every CS, pulse the shared RST and initialize all panels
+     * @return true if every panel initialized
+     */
+    bool initialize();
+
+    /**
+     * @brief Upload and refresh all panels, overlapping uploads with refreshes
+     * Returns when every panel has finished refreshing.
+     */
+    void display();
+
+    /**
+     * @brief Start a refresh on every panel without waiting for any of them
+     * Each upload runs while the panels before it refresh.
+     * @return false if a panel could not start (see EPDDisplay::displayAsync())
+     */
+    bool displayAsync();
+
+    /**
+     * @brief Check whether any panel is still refreshing
+     */
+    bool isRefreshing();
+
+    /**
+     * @brief Wait for every panel to finish refreshing
+     * @param timeout_ms Maximum time to wait in milliseconds
+     * @return true if all finished, false on timeout
+     */
+    bool waitRefresh(uint32_t timeout_ms = EPD_BUSY_TIMEOUT_MS);
+
+    /**
+     * @brief Put every panel into deep sleep
+     */
+    void sleep();
+
+    /**
+     * @brief Wake every panel
+     * A shared RST resets all controllers at once, so awake panels are put to
+     * sleep first and every panel is re-initialized.
+     */
+    void wakeUp();
+
+private:
+    EPDDisplay *m_panels[EPD_GROUP_MAX_PANELS];
+    int m_CS_pins[EPD_GROUP_MAX_PANELS]; // -1 for caller-provided transports
+    uint8_t m_count;
+    int m_CLK_pin;
+    int m_DIN_pin;
+    int m_DC_pin;
+    int m_RST_pin;
+    EPDDisplay::TRANSPORT m_transport;
+
+    /**
+     * @brief Pulse the shared RST line (no-op without one)
+     */
+    void pulseReset();
+
+    /**
+     * @brief Transport of the first panel: clock of the group's own waits
+     */
+    EPDTransport *link();
+};
+
+#endif // __EPDPANELGROUP_H
@@ -0,0 +1,261 @@
+#ifndef __EPDPIXELWRITER_H
+#define __EPDPIXELWRITER_H
+#include "EPDDisplay.h"
+
+/**
+ * @file EPDPixelWriter.h
+ * @brief Internal fast pixel path for the drawing primitives (not part of the public API).
+ *
+ * drawPixel() validates every call: range check, Debug() on failure, color
+ * switch, band check and a dirty-rectangle update per pixel. A primitive
+ * that knows its extent does that work once instead:
+ *
+ *   EPDPixelWriter writer(this);
+ *   if (!writer.begin(x0, y0, x1, y1))   // clip box (user coordinates)
+ *       return;                           // nothing visible
+ *   EPDColorMask mask = epdColorMask(color);
+ *   writer.put(x, y, mask);               // (x, y) inside the clip box
+ *   writer.putClipped(x, y, mask);        // any (x, y), one range test
+ *   writer.fill(x0, y0, x1, y1, mask);    // box or span, clipped, byte-wise
+ *
+ * begin() intersects the box with the display and with the rows currently
+ * in memory (banded rendering), and marks the clipped box dirty in one step.
+ * put() is then branch-free: the affine transform, the byte address and an
+ * AND/OR per plane with the masks resolved from COLOR. Plane bytes are
+ * EPD_PLANE_STRIDE apart (2 with EPD_INTERLEAVED_PLANES).
+ *
+ * NULL_COLOR (transparent) has no mask; primitives skip those pixels.
+ */
+
+/**
+ * @brief Bits a color leaves in each plane (blackBuffer 1 = not black, redBuffer 1 = not red)
+ */
+typedef struct
+{
+    uint8_t black;
+    uint8_t red;
+} EPDColorMask;
+
+/**
+ * @brief Resolve a color to its plane masks (NULL_COLOR resolves like WHITE)
+ */
+static inline EPDColorMask epdColorMask(EPDDisplay::COLOR color)
+{
+    EPDColorMask mask;
+    mask.black = (color == EPDDisplay::BLACK) ? 0x00 : 0xFF;
+    mask.red = (color == EPDDisplay::RED) ? 0x00 : 0xFF;
+    return mask;
+}
+
+class EPDPixelWriter
+{
+public:
+    /**
+     * @brief Snapshot the display's transform and buffers (set rotation, mirror and bands first)
+     */
+    EPDPixelWriter(EPDDisplay *display)
+        : m_display(display),
+          m_black(display->blackBuffer),
+          m_red(display->redBuffer),
+          m_widthByte(display->widthByte),
+          m_originX(display->transform.originX),
+          m_originRow(display->transform.originY - (int16_t)display->bufferRowOffset),
+          m_xStepX(display->transform.xStepX),
+          m_xStepY(display->transform.xStepY),
+          m_yStepX(display->transform.yStepX),
+          m_yStepY(display->transform.yStepY),
+          m_x0(0),
+          m_y0(0),
+          m_x1(-1),
+          m_y1(-1)
+    {
+    }
+
+    /**
+     * @brief Clip a box (user coordinates, inclusive) and mark it dirty
+     * @return false if no pixel of the box is visible or in memory
+     */
+    bool begin(int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+    {
+        const EPDDisplay::Transform &t = m_display->transform;
+        if (x0 < 0)
+            x0 = 0;
+        if (y0 < 0)
+            y0 = 0;
+        if (x1 > t.limitX - 1)
+            x1 = t.limitX - 1;
+        if (y1 > t.limitY - 1)
+            y1 = t.limitY - 1;
+
+        // Rows in memory, as a range on the user axis that maps to buffer Y
+        int32_t rowFirst = m_display->bufferRowOffset;
+        int32_t rowLast = rowFirst + m_display->bufferRows - 1;
+        if (t.yStepY != 0)
+        {
+            int32_t a = (rowFirst - t.originY) * t.yStepY;
+            int32_t b = (rowLast - t.originY) * t.yStepY;
+            if (y0 < (a < b ? a : b))
+                y0 = (a < b ? a : b);
+            if (y1 > (a < b ? b : a))
+                y1 = (a < b ? b : a);
+        }
+        else
+        {
+            int32_t a = (rowFirst - t.originY) * t.xStepY;
+            int32_t b = (rowLast - t.originY) * t.xStepY;
+            if (x0 < (a < b ? a : b))
+                x0 = (a < b ? a : b);
+            if (x1 > (a < b ? b : a))
+                x1 = (a < b ? b : a);
+        }
+
+        m_x0 = x0;
+        m_y0 = y0;
+        m_x1 = x1;
+        m_y1 = y1;
+        if (x0 > x1 || y0 > y1)
+        {
+            return false;
+        }
+
+        // Dirty box = bounding box of two opposite corners in buffer coordinates
+        uint16_t Xa = t.originX + x0 * t.xStepX + y0 * t.yStepX;
+        uint16_t Ya = t.originY + x0 * t.xStepY + y0 * t.yStepY;
+        uint16_t Xb = t.originX + x1 * t.xStepX + y1 * t.yStepX;
+        uint16_t Yb = t.originY + x1 * t.xStepY + y1 * t.yStepY;
+        EPDDisplay::DirtyRect box;
+        box.xStart = Xa < Xb ? Xa : Xb;
+        box.xEnd = Xa < Xb ? Xb : Xa;
+        box.yStart = Ya < Yb ? Ya : Yb;
+        box.yEnd = Ya < Yb ? Yb : Ya;
+        EPDDisplay::unionRect(&m_display->dirty, &box);
+        return true;
+    }
+
+    /**
+     * @brief Clip box of the last begin() (inclusive, empty when left() > right())
+     */
+    int32_t left() const { return m_x0; }
+    int32_t top() const { return m_y0; }
+    int32_t right() const { return m_x1; }
+    int32_t bottom() const { return m_y1; }
+
+    /**
+     * @brief Check whether a point is inside the clip box
+     */
+    bool contains(int32_t x, int32_t y) const
+    {
+        return (uint32_t)(x - m_x0) <= (uint32_t)(m_x1 - m_x0) &&
+               (uint32_t)(y - m_y0) <= (uint32_t)(m_y1 - m_y0);
+    }
+
+    /**
+     * @brief Write a pixel known to be inside the clip box
+     */
+    void put(uint16_t x, uint16_t y, EPDColorMask mask)
+    {
+        uint16_t X = m_originX + x * m_xStepX + y * m_yStepX;
+        uint16_t row = m_originRow + x * m_xStepY + y * m_yStepY;
+        uint32_t addr = ((X >> 3) + (uint32_t)row * m_widthByte) * EPD_PLANE_STRIDE;
+        uint8_t bit = 0x80 >> (X & 7);
+        m_black[addr] = (m_black[addr] & ~bit) | (bit & mask.black);
+        m_red[addr] = (m_red[addr] & ~bit) | (bit & mask.red);
+    }
+
+    /**
+     * @brief Fill a box (user coordinates, inclusive), clipped to the clip box
+     * Every rotation maps the box to a box in the buffer, which is filled
+     * buffer row by buffer row: partial edge bytes through masks, the full
+     * bytes between them with memset(). A horizontal span on an unrotated
+     * display is one such row; a vertical one is one masked byte per row.
+     */
+    void fill(int32_t x0, int32_t y0, int32_t x1, int32_t y1, EPDColorMask mask)
+    {
+        if (x0 < m_x0)
+            x0 = m_x0;
+        if (y0 < m_y0)
+            y0 = m_y0;
+        if (x1 > m_x1)
+            x1 = m_x1;
+        if (y1 > m_y1)
+            y1 = m_y1;
+        if (x0 > x1 || y0 > y1)
+        {
+            return;
+        }
+
+        uint16_t Xa = m_originX + x0 * m_xStepX + y0 * m_yStepX;
+        uint16_t Ra = m_originRow + x0 * m_xStepY + y0 * m_yStepY;
+        uint16_t Xb = m_originX + x1 * m_xStepX + y1 * m_yStepX;
+        uint16_t Rb = m_originRow + x1 * m_xStepY + y1 * m_yStepY;
+        uint16_t XStart = Xa < Xb ? Xa : Xb;
+        uint16_t XEnd = Xa < Xb ? Xb : Xa;
+        uint16_t RStart = Ra < Rb ? Ra : Rb;
+        uint16_t REnd = Ra < Rb ? Rb : Ra;
+
+        // MSB = leftmost pixel: keep the bits from XStart on / up to XEnd
+        uint16_t first = XStart >> 3;
+        uint16_t last = XEnd >> 3;
+        uint8_t leftBits = 0xFF >> (XStart & 7);
+        uint8_t rightBits = 0xFF << (7 - (XEnd & 7));
+        if (first == last)
+        {
+            leftBits &= rightBits;
+        }
+
+        for (uint16_t row = RStart; row <= REnd; row++)
+        {
+            uint8_t *black = m_black + (uint32_t)row * m_widthByte * EPD_PLANE_STRIDE;
+            uint8_t *red = m_red + (uint32_t)row * m_widthByte * EPD_PLANE_STRIDE;
+            uint32_t a = first * EPD_PLANE_STRIDE;
+            black[a] = (black[a] & ~leftBits) | (leftBits & mask.black);
+            red[a] = (red[a] & ~leftBits) | (leftBits & mask.red);
+            if (last > first)
+            {
+#if EPD_INTERLEAVED_PLANES
+                // Black and red bytes alternate: [black, red] per byte column
+                for (uint32_t i = a + 2; i < last * 2u; i += 2)
+                {
+                    black[i] = mask.black;
+                    black[i + 1] = mask.red;
+                }
+#else
+                memset(black + first + 1, mask.black, last - first - 1);
+                memset(red + first + 1, mask.red, last - first - 1);
+#endif
+                uint32_t b = last * EPD_PLANE_STRIDE;
+                black[b] = (black[b] & ~rightBits) | (rightBits & mask.black);
+                red[b] = (red[b] & ~rightBits) | (rightBits & mask.red);
+            }
+        }
+    }
+
+    /**
+     * @brief Write a pixel if it is inside the clip box
+     */
+    void putClipped(int32_t x, int32_t y, EPDColorMask mask)
+    {
+        if (contains(x, y))
+        {
+            put(x, y, mask);
+        }
+    }
+
+private:
+    EPDDisplay *m_display;
+    uint8_t *m_black;
+    uint8_t *m_red;
+    uint32_t m_widthByte;
+    int16_t m_originX;
+    int16_t m_originRow; // originY relative to the first row in memory
+    int8_t m_xStepX;
+    int8_t m_xStepY;
+    int8_t m_yStepX;
+    int8_t m_yStepY;
+    int32_t m_x0;
+    int32_t m_y0;
+    int32_t m_x1;
+    int32_t m_y1;
+};
+
+#endif // __EPDPIXELWRITER_H
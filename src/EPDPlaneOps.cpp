@@ -0,0 +1,288 @@
+/**
+ * @file EPDPlaneOps.cpp
+ * @brief 32-bit SWAR (SIMD within a register) kernels over plane bytes.
+ *
+ * Every kernel has the same shape:
+ *   head  — single bytes until dst is 4-byte aligned
+ *   body  — whole 32-bit words (32 pixels per load / store)
+ *   tail  — the remaining 0–3 bytes
+ * Two-buffer kernels need src to have the same alignment as dst; otherwise
+ * they stay byte-wise, because the ESP32 traps on unaligned word access.
+ * copy() is the exception: it feeds the uploads, whose rows start at any
+ * offset, so it merges two aligned source words per output word instead.
+ *
+ * Words are accessed through EPDWord, a may_alias type, so reading a
+ * uint8_t buffer as 32-bit words is well defined under strict aliasing.
+ *
+ * countSetBits() uses the classic SWAR popcount (pairs, nibbles, bytes, then
+ * one multiply to sum the four byte counts); the ESP32 has no popcount
+ * instruction, so this beats a call to __builtin_popcount() per word.
+ */
+#include "EPDPlaneOps.h"
+
+typedef uint32_t __attribute__((__may_alias__)) EPDWord;
+
+// Bytes before p is 4-byte aligned, at most length
+static inline uint32_t headBytes(const void *p, uint32_t length)
+{
+    uint32_t head = (4 - ((uintptr_t)p & 3)) & 3;
+    return head < length ? head : length;
+}
+
+// Both pointers can reach a word boundary together
+static inline bool sameAlignment(const void *a, const void *b)
+{
+    return (((uintptr_t)a ^ (uintptr_t)b) & 3) == 0;
+}
+
+static inline uint32_t popcount32(uint32_t v)
+{
+    v = v - ((v >> 1) & 0x55555555UL);
+    v = (v & 0x33333333UL) + ((v >> 2) & 0x33333333UL);
+    v = (v + (v >> 4)) & 0x0F0F0F0FUL;
+    return (uint32_t)(v * 0x01010101UL) >> 24; // Sum of the four byte counts
+}
+
+void EPDPlaneOps::fill(uint8_t *dst, uint8_t value, uint32_t length)
+{
+    uint32_t head = headBytes(dst, length);
+    uint32_t i;
+    for (i = 0; i < head; i++)
+    {
+        dst[i] = value;
+    }
+    uint32_t word = value * 0x01010101UL;
+    EPDWord *w = (EPDWord *)(dst + head);
+    uint32_t words = (length - head) / 4;
+    for (i = 0; i < words; i++)
+    {
+        w[i] = word;
+    }
+    for (i = head + words * 4; i < length; i++)
+    {
+        dst[i] = value;
+    }
+}
+
+void EPDPlaneOps::copy(uint8_t *dst, const uint8_t *src, uint32_t length, bool invert)
+{
+    uint8_t mask = invert ? 0xFF : 0x00;
+    uint32_t head = headBytes(dst, length);
+    uint32_t i;
+    for (i = 0; i < head; i++)
+    {
+        dst[i] = src[i] ^ mask;
+    }
+    uint32_t wordMask = mask * 0x01010101UL;
+    EPDWord *d = (EPDWord *)(dst + head);
+    const uint8_t *s = src + head;
+    uint32_t words = (length - head) / 4;
+    uint32_t r = (uintptr_t)s & 3;
+    // Off-alignment source: each output word is merged from two aligned
+    // loads, the last of which reaches 4 - r bytes past the final output
+    // word; drop that word if those bytes are not in src.
+    if (r != 0 && words > 0 && length - head - words * 4 < 4 - r)
+    {
+        words--;
+    }
+    if (r == 0)
+    {
+        for (i = 0; i < words; i++)
+        {
+            d[i] = ((const EPDWord *)s)[i] ^ wordMask;
+        }
+    }
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    else if (words > 0)
+    {
+        const EPDWord *a = (const EPDWord *)(s - r);
+        uint32_t shift = 8 * r;
+        // Bytes s[0 .. 3 - r] in the high lanes, without reading before s
+        uint32_t lo = 0;
+        for (uint32_t k = 0; k < 4 - r; k++)
+        {
+            lo |= (uint32_t)s[k] << (shift + 8 * k);
+        }
+        for (i = 0; i < words; i++)
+        {
+            uint32_t hi = a[i + 1];
+            d[i] = ((lo >> shift) | (hi << (32 - shift))) ^ wordMask;
+            lo = hi;
+        }
+    }
+#else
+    else
+    {
+        words = 0;
+    }
+#endif
+    for (i = head + words * 4; i < length; i++)
+    {
+        dst[i] = src[i] ^ mask;
+    }
+}
+
+void EPDPlaneOps::invert(uint8_t *dst, uint32_t length)
+{
+    uint32_t head = headBytes(dst, length);
+    uint32_t i;
+    for (i = 0; i < head; i++)
+    {
+        dst[i] = ~dst[i];
+    }
+    EPDWord *w = (EPDWord *)(dst + head);
+    uint32_t words = (length - head) / 4;
+    for (i = 0; i < words; i++)
+    {
+        w[i] = ~w[i];
+    }
+    for (i = head + words * 4; i < length; i++)
+    {
+        dst[i] = ~dst[i];
+    }
+}
+
+void EPDPlaneOps::mergeAnd(uint8_t *dst, const uint8_t *src, uint32_t length)
+{
+    uint32_t head = sameAlignment(dst, src) ? headBytes(dst, length) : length;
+    uint32_t i;
+    for (i = 0; i < head; i++)
+    {
+        dst[i] &= src[i];
+    }
+    EPDWord *d = (EPDWord *)(dst + head);
+    const EPDWord *s = (const EPDWord *)(src + head);
+    uint32_t words = (length - head) / 4;
+    for (i = 0; i < words; i++)
+    {
+        d[i] &= s[i];
+    }
+    for (i = head + words * 4; i < length; i++)
+    {
+        dst[i] &= src[i];
+    }
+}
+
+void EPDPlaneOps::mergeOr(uint8_t *dst, const uint8_t *src, uint32_t length)
+{
+    uint32_t head = sameAlignment(dst, src) ? headBytes(dst, length) : length;
+    uint32_t i;
+    for (i = 0; i < head; i++)
+    {
+        dst[i] |= src[i];
+    }
+    EPDWord *d = (EPDWord *)(dst + head);
+    const EPDWord *s = (const EPDWord *)(src + head);
+    uint32_t words = (length - head) / 4;
+    for (i = 0; i < words; i++)
+    {
+        d[i] |= s[i];
+    }
+    for (i = head + words * 4; i < length; i++)
+    {
+        dst[i] |= src[i];
+    }
+}
+
+void EPDPlaneOps::mergeXor(uint8_t *dst, const uint8_t *src, uint32_t length)
+{
+    uint32_t head = sameAlignment(dst, src) ? headBytes(dst, length) : length;
+    uint32_t i;
+    for (i = 0; i < head; i++)
+    {
+        dst[i] ^= src[i];
+    }
+    EPDWord *d = (EPDWord *)(dst + head);
+    const EPDWord *s = (const EPDWord *)(src + head);
+    uint32_t words = (length - head) / 4;
+    for (i = 0; i < words; i++)
+    {
+        d[i] ^= s[i];
+    }
+    for (i = head + words * 4; i < length; i++)
+    {
+        dst[i] ^= src[i];
+    }
+}
+
+int32_t EPDPlaneOps::findDifference(const uint8_t *a, const uint8_t *b, uint32_t length)
+{
+    uint32_t head = sameAlignment(a, b) ? headBytes(a, length) : length;
+    uint32_t i;
+    for (i = 0; i < head; i++)
+    {
+        if (a[i] != b[i])
+        {
+            return i;
+        }
+    }
+    const EPDWord *wa = (const EPDWord *)(a + head);
+    const EPDWord *wb = (const EPDWord *)(b + head);
+    uint32_t words = (length - head) / 4;
+    uint32_t w;
+    for (w = 0; w < words && wa[w] == wb[w]; w++)
+    {
+    }
+    // First differing word (or the tail): locate the byte
+    for (i = head + w * 4; i < length; i++)
+    {
+        if (a[i] != b[i])
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool EPDPlaneOps::isUniform(const uint8_t *src, uint8_t value, uint32_t length)
+{
+    uint32_t head = headBytes(src, length);
+    uint32_t i;
+    for (i = 0; i < head; i++)
+    {
+        if (src[i] != value)
+        {
+            return false;
+        }
+    }
+    uint32_t word = value * 0x01010101UL;
+    const EPDWord *w = (const EPDWord *)(src + head);
+    uint32_t words = (length - head) / 4;
+    for (i = 0; i < words; i++)
+    {
+        if (w[i] != word)
+        {
+            return false;
+        }
+    }
+    for (i = head + words * 4; i < length; i++)
+    {
+        if (src[i] != value)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t EPDPlaneOps::countSetBits(const uint8_t *src, uint32_t length)
+{
+    uint32_t head = headBytes(src, length);
+    uint32_t count = 0;
+    uint32_t i;
+    for (i = 0; i < head; i++)
+    {
+        count += popcount32(src[i]);
+    }
+    const EPDWord *w = (const EPDWord *)(src + head);
+    uint32_t words = (length - head) / 4;
+    for (i = 0; i < words; i++)
+    {
+        count += popcount32(w[i]);
+    }
+    for (i = head + words * 4; i < length; i++)
+    {
+        count += popcount32(src[i]);
+    }
+    return count;
+}
@@ -0,0 +1,81 @@
+#ifndef __EPDPLANEOPS_H
+#define __EPDPLANEOPS_H
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include "EPDHostShim.h"
+#endif
+
+/**
+ * @brief Word-wide kernels over framebuffer plane bytes
+ *
+ * Each operation handles 32 pixels (one 4-byte word) per step. A 110-byte
+ * row is rarely 4-byte aligned, so bytes before the first aligned word and
+ * after the last one are processed one at a time (head / tail); two-buffer
+ * operations use words only when both pointers share the same alignment,
+ * since unaligned word access faults on the ESP32. copy() goes word-wise
+ * for any pair of pointers (it shifts two aligned source words into one).
+ *
+ * The kernels work on plain byte ranges: one plane row, a whole plane, or a
+ * caller's own off-screen canvas. Pixel meaning is the caller's business
+ * (in blackBuffer a 0 bit is black ink, in redBuffer a 0 bit is red ink).
+ *
+ * Usage:
+ *   uint8_t canvas[110 * 40];
+ *   EPDPlaneOps::fill(canvas, 0xFF, sizeof(canvas));        // clear
+ *   EPDPlaneOps::mergeAnd(canvas, stamp, sizeof(canvas));    // overlay black ink
+ *   int32_t at = EPDPlaneOps::findDifference(a, b, length); // diff
+ */
+class EPDPlaneOps
+{
+public:
+    /**
+     * @brief Set length bytes to value
+     */
+    static void fill(uint8_t *dst, uint8_t value, uint32_t length);
+
+    /**
+     * @brief Copy length bytes (the ranges must not overlap)
+     * @param invert If true, each byte is stored as its bitwise NOT
+     */
+    static void copy(uint8_t *dst, const uint8_t *src, uint32_t length, bool invert = false);
+
+    /**
+     * @brief Replace length bytes by their bitwise NOT
+     */
+    static void invert(uint8_t *dst, uint32_t length);
+
+    /**
+     * @brief dst &= src over length bytes
+     */
+    static void mergeAnd(uint8_t *dst, const uint8_t *src, uint32_t length);
+
+    /**
+     * @brief dst |= src over length bytes
+     */
+    static void mergeOr(uint8_t *dst, const uint8_t *src, uint32_t length);
+
+    /**
+     * @brief dst ^= src over length bytes
+     */
+    static void mergeXor(uint8_t *dst, const uint8_t *src, uint32_t length);
+
+    /**
+     * @brief Find the first byte that differs between two ranges
+     * @return Offset of that byte, or -1 if the ranges are equal
+     */
+    static int32_t findDifference(const uint8_t *a, const uint8_t *b, uint32_t length);
+
+    /**
+     * @brief Check whether every byte of a range equals value
+     */
+    static bool isUniform(const uint8_t *src, uint8_t value, uint32_t length);
+
+    /**
+     * @brief Count the 1 bits of a range
+     * Ink pixels of a plane are the 0 bits: length * 8 - countSetBits().
+     */
+    static uint32_t countSetBits(const uint8_t *src, uint32_t length);
+};
+
+#endif // __EPDPLANEOPS_H
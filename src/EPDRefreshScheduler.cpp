@@ -0,0 +1,191 @@
+/**
+ * @file EPDRefreshScheduler.cpp
+ * @brief Refresh coalescing, rate limiting and full refresh policy (see EPDRefreshScheduler.h).
+ *
+ * Timing of a pending refresh:
+ *   - each request() has a due time, its millis() plus the hold time of its
+ *     priority; the pending refresh is due at the earliest of them, so a
+ *     PRIORITY_NORMAL request pulls a held PRIORITY_LOW one forward
+ *   - it starts once it is due and EPD_SCHED_MIN_INTERVAL_MS (or
+ *     setMinInterval()) has passed since the previous start
+ *   - an urgent request ignores both and only waits for the panel
+ *
+ * Times are compared as signed differences, so millis() wrapping after
+ * ~49 days does not stall the scheduler.
+ */
+#include "EPDRefreshScheduler.h"
+
+EPDRefreshScheduler::EPDRefreshScheduler(EPDDisplay *display)
+    : m_display(display),
+      m_minInterval(EPD_SCHED_MIN_INTERVAL_MS),
+      m_fullEvery(EPD_SCHED_FULL_EVERY),
+      m_fastCount(0),
+      m_pending(false),
+      m_urgent(false),
+      m_dueMs(0),
+      m_started(false),
+      m_lastStartMs(0)
+{
+    m_holdMs[PRIORITY_LOW] = EPD_SCHED_LOW_HOLD_MS;
+    m_holdMs[PRIORITY_NORMAL] = EPD_SCHED_NORMAL_HOLD_MS;
+    resetStats();
+}
+
+void EPDRefreshScheduler::setMinInterval(uint32_t ms)
+{
+    m_minInterval = ms;
+}
+
+void EPDRefreshScheduler::setHoldTime(PRIORITY priority, uint32_t ms)
+{
+    if (priority != PRIORITY_LOW && priority != PRIORITY_NORMAL)
+    {
+        Debug("Only PRIORITY_LOW and PRIORITY_NORMAL have a hold time\r\n");
+        return;
+    }
+    m_holdMs[priority] = ms;
+}
+
+void EPDRefreshScheduler::setFullRefreshEvery(uint8_t count)
+{
+    m_fullEvery = count;
+}
+
+void EPDRefreshScheduler::request(PRIORITY priority)
+{
+    uint32_t now = millis();
+    m_stats.requests++;
+
+    if (priority == PRIORITY_URGENT)
+    {
+        if (m_pending)
+        {
+            m_stats.coalesced++;
+        }
+        m_pending = true;
+        m_urgent = true;
+        m_dueMs = now;
+        poll();
+        return;
+    }
+
+    uint32_t due = now + m_holdMs[priority];
+    if (!m_pending)
+    {
+        m_pending = true;
+        m_dueMs = due;
+        return;
+    }
+    m_stats.coalesced++;
+    if ((int32_t)(due - m_dueMs) < 0)
+    {
+        m_dueMs = due;
+    }
+}
+
+bool EPDRefreshScheduler::poll()
+{
+    // Also observes completion of the running refresh
+    if (m_display->isRefreshing() || !m_pending)
+    {
+        return false;
+    }
+    if (timeUntilRefresh() > 0)
+    {
+        return false;
+    }
+    return startRefresh();
+}
+
+bool EPDRefreshScheduler::flush()
+{
+    if (m_pending)
+    {
+        m_display->waitRefresh();
+        startRefresh();
+    }
+    return m_display->waitRefresh();
+}
+
+uint32_t EPDRefreshScheduler::timeUntilRefresh()
+{
+    if (!m_pending)
+    {
+        return UINT32_MAX;
+    }
+    if (m_urgent)
+    {
+        return 0;
+    }
+
+    uint32_t now = millis();
+    int32_t wait = (int32_t)(m_dueMs - now);
+    if (m_started)
+    {
+        int32_t interval = (int32_t)(m_lastStartMs + m_minInterval - now);
+        if (interval > wait)
+        {
+            wait = interval;
+        }
+    }
+    return (wait > 0) ? (uint32_t)wait : 0;
+}
+
+void EPDRefreshScheduler::getStats(Stats *stats)
+{
+    if (stats != NULL)
+    {
+        *stats = m_stats;
+    }
+}
+
+void EPDRefreshScheduler::resetStats()
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+bool EPDRefreshScheduler::startRefresh()
+{
+    EPDDisplay::REFRESH_MODE mode = m_display->getRefreshMode();
+    bool forceFull = m_fullEvery > 0 && m_fastCount >= m_fullEvery &&
+                     mode != EPDDisplay::REFRESH_FULL_TRICOLOR;
+    if (forceFull)
+    {
+        m_display->setRefreshMode(EPDDisplay::REFRESH_FULL_TRICOLOR);
+    }
+
+    // The waveform is loaded when the refresh starts, so the mode can be restored right after
+    bool started = m_display->isDoubleBuffered() ? m_display->commit() : m_display->displayAsync();
+    if (forceFull)
+    {
+        m_display->setRefreshMode(mode);
+    }
+    if (!started)
+    {
+        return false;
+    }
+
+    if (m_display->getLastRefreshMode() == EPDDisplay::REFRESH_FULL_TRICOLOR)
+    {
+        m_fastCount = 0;
+    }
+    else if (m_fastCount < 255)
+    {
+        m_fastCount++;
+    }
+
+    m_stats.refreshes++;
+    if (forceFull)
+    {
+        m_stats.forcedFull++;
+    }
+    if (m_urgent)
+    {
+        m_stats.urgent++;
+    }
+    m_pending = false;
+    m_urgent = false;
+    m_started = true;
+    m_lastStartMs = millis();
+    return true;
+}
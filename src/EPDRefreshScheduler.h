@@ -0,0 +1,155 @@
+#ifndef __EPDREFRESHSCHEDULER_H
+#define __EPDREFRESHSCHEDULER_H
+#include "EPDDisplay.h"
+
+// Minimum time between two refresh starts (Waveshare recommends >= 180 s)
+#define EPD_SCHED_MIN_INTERVAL_MS 180000UL
+// Default hold of a PRIORITY_NORMAL request, to collect a burst of updates
+#define EPD_SCHED_NORMAL_HOLD_MS 2000UL
+// Default hold of a PRIORITY_LOW request
+#define EPD_SCHED_LOW_HOLD_MS 600000UL
+// Fast refreshes after which one full tricolor refresh is forced
+#define EPD_SCHED_FULL_EVERY 5
+
+/**
+ * @file EPDRefreshScheduler.h
+ * @brief Rate-limited, coalescing refreshes on top of one EPDDisplay.
+ *
+ * Application code draws as usual and calls request() instead of display().
+ * The scheduler decides when the panel actually refreshes:
+ *   - a request is held for a short time (per priority) so that a burst of
+ *     updates ends up in one frame; requests made while one is pending are
+ *     merged into it
+ *   - two refreshes never start less than the minimum interval apart
+ *   - PRIORITY_URGENT skips both and starts as soon as the panel is idle
+ *   - after a number of fast (black/white) refreshes, the next one is a full
+ *     tricolor refresh to clear ghosting
+ *
+ * The frame is taken from the framebuffer when the refresh starts, so every
+ * drawing call made up to that point is included. Refreshes run
+ * asynchronously (displayAsync(), or commit() with double buffering); call
+ * poll() regularly, e.g. from loop().
+ *
+ * Usage:
+ *   EPDRefreshScheduler scheduler(&display);
+ *   display.drawNumber(...);
+ *   scheduler.request();
+ *   ...
+ *   scheduler.poll();
+ */
+class EPDRefreshScheduler
+{
+public:
+    /**
+     * @brief Request priorities
+     * PRIORITY_LOW and PRIORITY_NORMAL differ only in their hold time.
+     */
+    typedef enum
+    {
+        PRIORITY_LOW = 0,
+        PRIORITY_NORMAL = 1,
+        PRIORITY_URGENT = 2
+    } PRIORITY;
+
+    /**
+     * @brief Scheduler counters since construction or resetStats()
+     */
+    typedef struct
+    {
+        uint32_t requests;   // request() calls
+        uint32_t coalesced;  // Requests merged into an already pending refresh
+        uint32_t refreshes;  // Refreshes started
+        uint32_t urgent;     // Refreshes started by a PRIORITY_URGENT request
+        uint32_t forcedFull; // Full refreshes forced by setFullRefreshEvery()
+    } Stats;
+
+    /**
+     * @brief Constructor
+     * @param display Initialized display to drive (not owned)
+     */
+    EPDRefreshScheduler(EPDDisplay *display);
+
+    /**
+     * @brief Set the minimum time between two refresh starts
+     * @param ms Interval in milliseconds (0 = no limit)
+     */
+    void setMinInterval(uint32_t ms);
+
+    /**
+     * @brief Set how long a request of a priority waits for further changes
+     * @param priority PRIORITY_LOW or PRIORITY_NORMAL (urgent requests are never held)
+     * @param ms Hold time in milliseconds
+     */
+    void setHoldTime(PRIORITY priority, uint32_t ms);
+
+    /**
+     * @brief Force a full tricolor refresh after a number of fast ones
+     * Counts refreshes that did not use REFRESH_FULL_TRICOLOR (see
+     * EPDDisplay::getLastRefreshMode()); has no effect while the display's
+     * refresh mode is REFRESH_FULL_TRICOLOR.
+     * @param count Fast refreshes between two full ones (0 = never force)
+     */
+    void setFullRefreshEvery(uint8_t count);
+
+    /**
+     * @brief Mark the framebuffer as changed
+     * PRIORITY_URGENT starts the refresh right away if the panel is idle,
+     * otherwise as soon as the running refresh ends.
+     * @param priority Request priority
+     */
+    void request(PRIORITY priority = PRIORITY_NORMAL);
+
+    /**
+     * @brief Start the pending refresh if it is due; call regularly
+     * Also completes a running refresh (see EPDDisplay::isRefreshing()).
+     * @return true if a refresh was started by this call
+     */
+    bool poll();
+
+    /**
+     * @brief Start the pending refresh now, whatever its timing, and wait for it
+     * @return true if no refresh is running anymore
+     */
+    bool flush();
+
+    /**
+     * @brief Check whether a requested refresh has not started yet
+     */
+    bool isPending() { return m_pending; }
+
+    /**
+     * @brief Time until the pending refresh may start
+     * @return Milliseconds (0 = due now), or UINT32_MAX if nothing is pending
+     */
+    uint32_t timeUntilRefresh();
+
+    /**
+     * @brief Read the scheduler counters
+     */
+    void getStats(Stats *stats);
+
+    /**
+     * @brief Reset the scheduler counters
+     */
+    void resetStats();
+
+private:
+    EPDDisplay *m_display;
+    uint32_t m_minInterval;
+    uint32_t m_holdMs[2]; // PRIORITY_LOW, PRIORITY_NORMAL
+    uint8_t m_fullEvery;
+    uint8_t m_fastCount;  // Fast refreshes since the last full one
+    bool m_pending;
+    bool m_urgent;
+    uint32_t m_dueMs;     // millis() from which the pending request may start
+    bool m_started;       // A refresh has been started (m_lastStartMs valid)
+    uint32_t m_lastStartMs;
+    Stats m_stats;
+
+    /**
+     * @brief Start the pending refresh, applying the full refresh policy
+     */
+    bool startRefresh();
+};
+
+#endif // __EPDREFRESHSCHEDULER_H
@@ -0,0 +1,164 @@
+/**
+ * @file EPDTransport.cpp
+ * @brief Default behaviour shared by all EPDTransport implementations.
+ *
+ * Besides writeDataBlock() and writeDataStrided(), this holds the Arduino
+ * implementation of the control lines and the clock. Transports override
+ * these only when the panel is reached some other way (e.g. the mock, which
+ * simulates BUSY).
+ *
+ * sleepWhileBusy() uses ESP32 light sleep: the CPU and most peripherals are
+ * clock-gated while the panel refreshes, RAM and GPIO state are kept, and
+ * millis() / micros() stay correct across the sleep.
+ */
+#include "EPDDisplay.h"
+
+#if defined(ESP32)
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#endif
+
+void EPDTransport::writeDataBlock(const uint8_t *data, uint32_t length, bool invert)
+{
+    beginData();
+    writeDataSpan(data, length, invert);
+    endData();
+}
+
+void EPDTransport::writeDataStrided(const uint8_t *data, uint32_t length, uint8_t stride, bool invert)
+{
+    uint8_t chunk[32];
+    while (length > 0)
+    {
+        uint32_t n = (length > sizeof(chunk)) ? sizeof(chunk) : length;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            chunk[i] = data[i * stride];
+        }
+        writeDataSpan(chunk, n, invert);
+        data += n * stride;
+        length -= n;
+    }
+}
+
+void EPDTransport::setControlPins(int busy_pin, int rst_pin)
+{
+    m_BUSY_pin = busy_pin;
+    m_RST_pin = rst_pin;
+    if (m_BUSY_pin >= 0)
+    {
+        pinMode(m_BUSY_pin, INPUT);
+    }
+    if (m_RST_pin >= 0)
+    {
+        pinMode(m_RST_pin, OUTPUT);
+    }
+}
+
+void EPDTransport::reset(uint32_t low_ms, uint32_t settle_ms)
+{
+    if (m_RST_pin >= 0)
+    {
+        digitalWrite(m_RST_pin, 0);
+        delayMs(low_ms);
+        digitalWrite(m_RST_pin, 1);
+    }
+    delayMs(settle_ms);
+}
+
+bool EPDTransport::isBusy()
+{
+    // BUSY is HIGH while the controller is processing
+    return m_BUSY_pin >= 0 && digitalRead(m_BUSY_pin) == HIGH;
+}
+
+bool EPDTransport::waitBusy(uint32_t timeout_ms)
+{
+    uint32_t start = nowMs();
+    while (isBusy())
+    {
+        if (nowMs() - start > timeout_ms)
+        {
+            return false;
+        }
+        delayMs(1); // Yields to other FreeRTOS tasks
+    }
+    return true;
+}
+
+bool EPDTransport::sleepWhileBusy(uint32_t timeout_ms, uint32_t *slept_us)
+{
+    *slept_us = 0;
+#if defined(ESP32)
+    if (m_BUSY_pin < 0)
+    {
+        return waitBusy(timeout_ms);
+    }
+
+    // Wake when BUSY goes low (idle); the timer ends the sleep on timeout if
+    // the edge never comes
+    gpio_num_t pin = (gpio_num_t)m_BUSY_pin;
+    gpio_wakeup_enable(pin, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+
+    uint32_t start = nowMs();
+    while (isBusy())
+    {
+        uint32_t elapsed = nowMs() - start;
+        if (elapsed > timeout_ms)
+        {
+            break;
+        }
+        esp_sleep_enable_timer_wakeup((uint64_t)(timeout_ms - elapsed + 1) * 1000);
+        uint32_t before = nowUs();
+        if (esp_light_sleep_start() == ESP_OK)
+        {
+            *slept_us += nowUs() - before;
+        }
+        else
+        {
+            delayMs(1); // Sleep rejected (e.g. a wakeup already pending): poll
+        }
+    }
+
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+    gpio_wakeup_disable(pin);
+    return !isBusy();
+#else
+    return waitBusy(timeout_ms);
+#endif
+}
+
+bool EPDTransport::attachBusyInterrupt(void (*handler)(void *), void *arg)
+{
+    if (m_BUSY_pin < 0)
+    {
+        return false;
+    }
+    attachInterruptArg(digitalPinToInterrupt(m_BUSY_pin), handler, arg, FALLING);
+    return true;
+}
+
+void EPDTransport::detachBusyInterrupt()
+{
+    if (m_BUSY_pin >= 0)
+    {
+        detachInterrupt(digitalPinToInterrupt(m_BUSY_pin));
+    }
+}
+
+void EPDTransport::delayMs(uint32_t ms)
+{
+    delay(ms);
+}
+
+uint32_t EPDTransport::nowMs()
+{
+    return millis();
+}
+
+uint32_t EPDTransport::nowUs()
+{
+    return micros();
+}
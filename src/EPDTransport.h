@@ -0,0 +1,572 @@
+#ifndef __EPDTRANSPORT_H
+#define __EPDTRANSPORT_H
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include "EPDHostShim.h"
+#endif
+
+/**
+ * @brief Hardware abstraction between EPDDisplay and the panel controller
+ *
+ * A transport moves command and data bytes over the 4-wire SPI link
+ * (DC, CS, CLK, DIN) and owns the rest of the panel interface: the RST and
+ * BUSY lines, delays and the clock. EPDDisplay owns no SPI, GPIO or timing
+ * code of its own; it talks to the controller exclusively through this
+ * interface, which makes it possible to swap the bit-banged link for the
+ * ESP32 SPI peripheral, or for a recording mock on a host.
+ *
+ * The control and timing methods have Arduino defaults (digitalWrite /
+ * digitalRead on the pins given to setControlPins(), delay(), millis()), so
+ * a byte transport only has to implement the pure virtual methods.
+ */
+class EPDTransport
+{
+public:
+    EPDTransport() : m_BUSY_pin(-1), m_RST_pin(-1) {}
+    virtual ~EPDTransport() {}
+
+    /**
+     * @brief Configure pins / peripheral. Called once from EPDDisplay::initialize()
+     * @return true if the transport is ready, false if it could not be set up
+     */
+    virtual bool begin() = 0;
+
+    /**
+     * @brief Send one command byte (DC low)
+     * @param command Command register value
+     */
+    virtual void writeCommand(uint8_t command) = 0;
+
+    /**
+     * @brief Send one data byte (DC high)
+     * @param data Data byte
+     */
+    virtual void writeData(uint8_t data) = 0;
+
+    /**
+     * @brief Start a data burst: DC high and CS low until endData()
+     * Only writeDataSpan() / writeDataRepeat() may be called inside a burst.
+     */
+    virtual void beginData() = 0;
+
+    /**
+     * @brief Stream bytes inside the current data burst
+     * @param data Pointer to the bytes to send
+     * @param length Number of bytes
+     * @param invert If true, each byte is sent as its bitwise NOT
+     */
+    virtual void writeDataSpan(const uint8_t *data, uint32_t length, bool invert = false) = 0;
+
+    /**
+     * @brief Stream every stride-th byte inside the current data burst
+     * Used for interleaved framebuffer planes (EPD_INTERLEAVED_PLANES). The
+     * default gathers the bytes into a small stack buffer and passes it to
+     * writeDataSpan(), so transports that still read the caller's memory
+     * after writeDataSpan() returns (zero-copy DMA) must override it.
+     * @param data Pointer to the first byte
+     * @param length Number of bytes to send
+     * @param stride Distance between two sent bytes
+     * @param invert If true, each byte is sent as its bitwise NOT
+     */
+    virtual void writeDataStrided(const uint8_t *data, uint32_t length, uint8_t stride, bool invert = false);
+
+    /**
+     * @brief Stream the same byte `count` times inside the current data burst
+     * @param value Byte to repeat
+     * @param count Number of bytes
+     */
+    virtual void writeDataRepeat(uint8_t value, uint32_t count) = 0;
+
+    /**
+     * @brief End the current data burst (CS high)
+     */
+    virtual void endData() = 0;
+
+    /**
+     * @brief Send a block of data bytes in a single burst
+     * Shorthand for beginData(), writeDataSpan(), endData().
+     * @param data Pointer to the bytes to send
+     * @param length Number of bytes
+     * @param invert If true, each byte is sent as its bitwise NOT
+     */
+    void writeDataBlock(const uint8_t *data, uint32_t length, bool invert = false);
+
+    /**
+     * @brief Whether uploads are faster from internal, DMA-capable RAM
+     * DMA transports can send straight out of such framebuffers; anything
+     * else (e.g. PSRAM) has to be copied through a bounce buffer first.
+     * Used by EPDDisplay::ALLOC_AUTO to place the framebuffers.
+     */
+    virtual bool prefersDmaMemory() const { return false; }
+
+    /**
+     * @brief Set and configure the BUSY (input) and RST (output) pins
+     * Called by EPDDisplay::initialize() when the display was given pins;
+     * -1 leaves a line unused.
+     * @param busy_pin BUSY signal pin
+     * @param rst_pin RST signal pin
+     */
+    virtual void setControlPins(int busy_pin, int rst_pin);
+
+    /**
+     * @brief BUSY / RST pins given to setControlPins(), -1 if unused
+     */
+    int busyPin() const { return m_BUSY_pin; }
+    int resetPin() const { return m_RST_pin; }
+
+    /**
+     * @brief Hardware reset: RST low for low_ms, then high and wait settle_ms
+     */
+    virtual void reset(uint32_t low_ms, uint32_t settle_ms);
+
+    /**
+     * @brief Current BUSY level (true = controller busy)
+     */
+    virtual bool isBusy();
+
+    /**
+     * @brief Wait until the controller releases BUSY
+     * @param timeout_ms Give up after this many milliseconds
+     * @return true if BUSY was released, false on timeout
+     */
+    virtual bool waitBusy(uint32_t timeout_ms);
+
+    /**
+     * @brief Wait until the controller releases BUSY with the CPU in light sleep
+     * On ESP32 the BUSY pin is armed as a GPIO wakeup source (level low) and
+     * a timer wakeup bounds the sleep to the timeout. Elsewhere this is
+     * waitBusy() and nothing is slept.
+     * @param timeout_ms Give up after this many milliseconds
+     * @param slept_us Set to the time actually spent in light sleep
+     * @return true if BUSY was released, false on timeout
+     */
+    virtual bool sleepWhileBusy(uint32_t timeout_ms, uint32_t *slept_us);
+
+    /**
+     * @brief Call handler(arg) from an interrupt when BUSY is released
+     * @return false if the transport cannot signal BUSY by interrupt (callers then poll isBusy())
+     */
+    virtual bool attachBusyInterrupt(void (*handler)(void *), void *arg);
+
+    /**
+     * @brief Remove the handler installed by attachBusyInterrupt()
+     */
+    virtual void detachBusyInterrupt();
+
+    /**
+     * @brief Block for ms milliseconds
+     */
+    virtual void delayMs(uint32_t ms);
+
+    /**
+     * @brief Milliseconds since start-up (wraps like millis())
+     */
+    virtual uint32_t nowMs();
+
+    /**
+     * @brief Microseconds since start-up (wraps like micros())
+     */
+    virtual uint32_t nowUs();
+
+protected:
+    int m_BUSY_pin;
+    int m_RST_pin;
+};
+
+/**
+ * @brief Software (bit-banged) SPI transport — works on any four GPIOs
+ */
+class EPDBitBangTransport : public EPDTransport
+{
+public:
+    /**
+     * @brief Constructor with pin parameters
+     * @param dc_pin DC signal pin
+     * @param cs_pin CS signal pin
+     * @param clk_pin CLK signal pin (SCK)
+     * @param din_pin DIN signal pin (MOSI)
+     */
+    EPDBitBangTransport(int dc_pin, int cs_pin, int clk_pin, int din_pin);
+
+    bool begin();
+    void writeCommand(uint8_t command);
+    void writeData(uint8_t data);
+    void beginData();
+    void writeDataSpan(const uint8_t *data, uint32_t length, bool invert = false);
+    void writeDataRepeat(uint8_t value, uint32_t count);
+    void endData();
+
+private:
+    int m_DC_pin;
+    int m_CS_pin;
+    int m_CLK_pin;
+    int m_DIN_pin;
+    uint8_t m_DIN_level; // Last level driven on DIN inside a burst
+
+    /**
+     * @brief Write a byte via SPI
+     * @param value Byte value to write
+     */
+    void SPI_WriteByte(uint8_t value);
+
+    /**
+     * @brief Clock out one byte with CS already low, skipping redundant DIN writes
+     * @param value Byte value to write
+     */
+    void shiftByte(uint8_t value);
+};
+
+/**
+ * @brief ESP32 hardware SPI (VSPI / HSPI) transport with DMA block transfers
+ *
+ * Command and single data bytes go out as short polling transactions.
+ * Inside a data burst, spans are queued as a chain of DMA transactions,
+ * double-buffered so the next chunk is prepared while the previous one is on
+ * the wire. On non-ESP32 builds begin() returns false.
+ */
+class EPDHwSpiTransport : public EPDTransport
+{
+public:
+    /**
+     * @brief SPI peripheral selection
+     * Available buses: SPI_BUS_VSPI (default pins CLK=18, MOSI=23), SPI_BUS_HSPI (default pins CLK=14, MOSI=13)
+     */
+    typedef enum
+    {
+        SPI_BUS_VSPI = 0,
+        SPI_BUS_HSPI = 1
+    } SPI_BUS;
+
+    /**
+     * @brief Constructor with pin parameters
+     * @param dc_pin DC signal pin
+     * @param cs_pin CS signal pin (driven as a GPIO so it can stay low across a whole plane)
+     * @param clk_pin CLK signal pin (SCK)
+     * @param din_pin DIN signal pin (MOSI)
+     * @param bus SPI peripheral to use (SPI_BUS_VSPI, SPI_BUS_HSPI)
+     * @param clock_hz SPI clock frequency in Hz (the controller accepts up to 20 MHz)
+     */
+    EPDHwSpiTransport(int dc_pin, int cs_pin, int clk_pin, int din_pin, SPI_BUS bus = SPI_BUS_VSPI, uint32_t clock_hz = 10000000);
+
+    /**
+     * @brief Destructor - releases the SPI device, bus and DMA chunk buffers
+     */
+    ~EPDHwSpiTransport();
+
+    bool begin();
+    void writeCommand(uint8_t command);
+    void writeData(uint8_t data);
+    void beginData();
+    void writeDataSpan(const uint8_t *data, uint32_t length, bool invert = false);
+    void writeDataStrided(const uint8_t *data, uint32_t length, uint8_t stride, bool invert = false);
+    void writeDataRepeat(uint8_t value, uint32_t count);
+    void endData();
+    bool prefersDmaMemory() const { return true; }
+
+private:
+    int m_DC_pin;
+    int m_CS_pin;
+    int m_CLK_pin;
+    int m_DIN_pin;
+    SPI_BUS m_bus;
+    uint32_t m_clock_hz;
+
+    void *m_device;      // spi_device_handle_t (kept opaque to avoid IDF headers here)
+    bool m_busReady;     // spi_bus_initialize() succeeded
+    uint8_t *m_chunk[2]; // DMA-capable bounce buffers
+    void *m_trans;       // spi_transaction_t[2], one per bounce buffer
+    uint8_t m_slot;      // Next transaction slot to fill
+    uint8_t m_inFlight;  // Queued transactions not yet collected
+
+    /**
+     * @brief Queue one DMA transaction of at most one chunk, waiting for a free slot
+     * @param tx Bytes to send (DMA-capable memory)
+     * @param length Number of bytes (≤ one chunk)
+     */
+    void queueChunk(const uint8_t *tx, uint32_t length);
+
+    /**
+     * @brief Wait until all queued transactions have completed
+     */
+    void drain();
+
+    /**
+     * @brief Send one byte with DC at the given level
+     */
+    void writeByte(uint8_t value, uint8_t dc);
+};
+
+class EPDMockBus;
+
+/**
+ * @brief Recording transport for host-side tests
+ *
+ * Talks to no hardware. Every byte is appended to an in-memory log together
+ * with its DC level and a timestamp, so tests can assert on command ordering,
+ * upload volume and timing without a panel. On a host build the timestamps
+ * come from the virtual clock of EPDHostShim.
+ *
+ * BUSY can be simulated with setBusyTime(): the mock then reports BUSY for
+ * that long after every activation (0x20), on top of the BUSY pin level.
+ *
+ * setLatencyModel() goes further and turns the mock into a timing model of
+ * a real link and panel: every byte costs the transport's per-byte time, and
+ * each controller operation (refresh by kind, LUT load, software reset,
+ * auto write) keeps BUSY high for its own duration. On a host the costs are
+ * charged to the virtual clock, so a whole frame "takes" its real-world time
+ * in microseconds of host time.
+ */
+class EPDMockTransport : public EPDTransport
+{
+public:
+    /**
+     * @brief One recorded byte
+     */
+    typedef struct
+    {
+        uint8_t value;
+        bool isCommand;
+        uint32_t timeUs; // nowUs() when the byte was sent
+    } Entry;
+
+    /**
+     * @brief Link and panel timing charged by the mock (see setLatencyModel())
+     */
+    typedef struct
+    {
+        uint32_t commandNs;   // One command byte (DC low, CS pulse)
+        uint32_t dataNs;      // One data byte inside a burst
+        uint32_t burstNs;     // Fixed cost of a data burst or of a lone data byte (CS/DC setup, transaction)
+        uint32_t fullMs;      // BUSY after a refresh with the internal temperature (0x22 & 0x04)
+        uint32_t fastMs;      // BUSY after a refresh with a forced temperature (0x1A)
+        uint32_t partialMs;   // BUSY after a display mode 2 refresh (0x22 & 0x08)
+        uint32_t loadMs;      // BUSY after an activation without display (LUT / temperature load)
+        uint32_t swResetMs;   // BUSY after 0x12
+        uint32_t autoWriteMs; // BUSY after 0x46 / 0x47
+    } LatencyModel;
+
+    /**
+     * @brief Typical figures for an ESP32 at 240 MHz and the 7.5" HD panel at room temperature
+     * LATENCY_BITBANG: EPDBitBangTransport (digitalWrite per bit),
+     * LATENCY_FAST_GPIO: EPDDisplayT register writes,
+     * LATENCY_HWSPI_DMA: EPDHwSpiTransport at 10 MHz
+     */
+    static const LatencyModel LATENCY_BITBANG;
+    static const LatencyModel LATENCY_FAST_GPIO;
+    static const LatencyModel LATENCY_HWSPI_DMA;
+
+    EPDMockTransport();
+
+    /**
+     * @brief Destructor - frees the log
+     */
+    ~EPDMockTransport();
+
+    bool begin();
+    void writeCommand(uint8_t command);
+    void writeData(uint8_t data);
+    void beginData();
+    void writeDataSpan(const uint8_t *data, uint32_t length, bool invert = false);
+    void writeDataRepeat(uint8_t value, uint32_t count);
+    void endData();
+    void reset(uint32_t low_ms, uint32_t settle_ms);
+    bool isBusy();
+
+    /**
+     * @brief Skips the clock to the end of the simulated BUSY time and reports it all as slept
+     */
+    bool sleepWhileBusy(uint32_t timeout_ms, uint32_t *slept_us);
+
+    /**
+     * @brief Simulated BUSY time after each activation command (0x20)
+     * @param ms Milliseconds of BUSY (0 = none, the default)
+     */
+    void setBusyTime(uint32_t ms) { m_busyTimeMs = ms; }
+
+    /**
+     * @brief Charge per-byte and BUSY times from a latency model (NULL = off, the default)
+     * Replaces setBusyTime(). The model must stay valid while it is set.
+     */
+    void setLatencyModel(const LatencyModel *model) { m_model = model; }
+
+    /**
+     * @brief Put this mock on a shared bus with others (see EPDMockBus)
+     * @param bus Bus to record on (must stay valid), NULL to detach
+     * @return Chip select index of this mock on the bus
+     */
+    uint8_t attachBus(EPDMockBus *bus);
+
+    /**
+     * @brief Number of hardware resets since the last clearLog()
+     */
+    uint32_t resetCount() const { return m_resets; }
+
+    /**
+     * @brief Forget all recorded bytes and reset counters
+     */
+    void clearLog();
+
+    /**
+     * @brief Number of recorded entries (commands + data)
+     */
+    uint32_t entryCount() const { return m_count; }
+
+    /**
+     * @brief Recorded entry at index (0 = oldest)
+     */
+    const Entry &entry(uint32_t index) const { return m_log[index]; }
+
+    /**
+     * @brief Number of command bytes sent since the last clearLog()
+     */
+    uint32_t commandCount() const { return m_commands; }
+
+    /**
+     * @brief Number of data bytes sent since the last clearLog()
+     */
+    uint32_t dataCount() const { return m_data; }
+
+    /**
+     * @brief Number of data bursts (beginData() … endData()) since the last clearLog()
+     */
+    uint32_t burstCount() const { return m_bursts; }
+
+    /**
+     * @brief Number of data bytes that followed the last occurrence of a command
+     * @param command Command register value
+     * @return Data bytes sent after that command, 0 if the command was never sent
+     */
+    uint32_t dataAfterCommand(uint8_t command) const;
+
+    /**
+     * @brief Find the next occurrence of a command in the log
+     * @param command Command register value
+     * @param start Index to start searching from
+     * @return Index of the command entry (its data bytes follow it), -1 if not found
+     */
+    int32_t findCommand(uint8_t command, uint32_t start = 0) const;
+
+private:
+    Entry *m_log;
+    uint32_t m_count;
+    uint32_t m_capacity;
+    uint32_t m_commands;
+    uint32_t m_data;
+    uint32_t m_bursts;
+    uint32_t m_resets;
+    uint32_t m_busyTimeMs;
+    uint32_t m_busyStart; // nowUs() when BUSY was raised
+    uint32_t m_busyUs;    // How long it stays raised
+    bool m_busyArmed;
+    const LatencyModel *m_model;
+    uint32_t m_pendingNs; // Byte costs not yet charged to the clock
+    uint8_t m_command;    // Last command, for the data bytes that follow
+    uint8_t m_sequence;   // Last 0x22 value
+    bool m_forcedTemperature; // 0x1A since the last 0x18
+    bool m_began;
+    bool m_inBurst;
+    EPDMockBus *m_bus;
+    uint8_t m_busCs;      // Chip select index on m_bus
+
+    void append(uint8_t value, bool isCommand);
+
+    /**
+     * @brief Advance the clock by ns (whole microseconds are charged, the rest is carried)
+     */
+    void charge(uint32_t ns);
+
+    /**
+     * @brief Hold BUSY high for ms from now
+     */
+    void raiseBusy(uint32_t ms);
+};
+
+// Chip selects one EPDMockBus can record
+#define EPD_MOCK_BUS_PANELS 8
+
+/**
+ * @brief Shared SPI link of several mocks, for testing panel groups on a host
+ *
+ * Each attached EPDMockTransport stands for one panel with its own chip
+ * select on a common CLK / DIN (/ DC) link. Every byte of every panel lands
+ * in one log, tagged with the chip select that sent it, and two properties
+ * of the traffic are checked as it happens:
+ *   - CS isolation: a transfer must not start while another chip select
+ *     holds the bus inside a data burst (conflicts())
+ *   - overlap: bytes sent to one panel while another attached panel holds
+ *     BUSY high (overlappedBytes()) are the uploads a panel group hides
+ *     behind a refresh
+ */
+class EPDMockBus
+{
+public:
+    /**
+     * @brief One byte on the shared link
+     */
+    typedef struct
+    {
+        uint8_t cs; // Chip select index of the sending mock
+        uint8_t value;
+        bool isCommand;
+        uint32_t timeUs;
+    } Entry;
+
+    EPDMockBus();
+
+    /**
+     * @brief Destructor - frees the log
+     */
+    ~EPDMockBus();
+
+    /**
+     * @brief Number of recorded entries, all chip selects
+     */
+    uint32_t entryCount() const { return m_count; }
+
+    /**
+     * @brief Recorded entry at index (0 = oldest)
+     */
+    const Entry &entry(uint32_t index) const { return m_log[index]; }
+
+    /**
+     * @brief Transfers started while another chip select held the bus
+     */
+    uint32_t conflicts() const { return m_conflicts; }
+
+    /**
+     * @brief Bytes sent while at least one other attached panel was busy
+     */
+    uint32_t overlappedBytes() const { return m_overlapped; }
+
+    /**
+     * @brief Number of times consecutive transfers came from different chip selects
+     */
+    uint32_t switches() const { return m_switches; }
+
+    /**
+     * @brief Forget all recorded bytes and reset counters
+     */
+    void clearLog();
+
+private:
+    friend class EPDMockTransport;
+
+    EPDMockTransport *m_panels[EPD_MOCK_BUS_PANELS];
+    uint8_t m_panelCount;
+    int m_selected; // Chip select inside a data burst, -1 = bus idle
+    int m_last;     // Chip select of the previous transfer, -1 = none
+    Entry *m_log;
+    uint32_t m_count;
+    uint32_t m_capacity;
+    uint32_t m_conflicts;
+    uint32_t m_overlapped;
+    uint32_t m_switches;
+
+    uint8_t attach(EPDMockTransport *panel);
+    void select(uint8_t cs);
+    void release(uint8_t cs);
+    void transfer(uint8_t cs, uint8_t value, bool isCommand);
+};
+
+#endif // __EPDTRANSPORT_H
@@ -0,0 +1,138 @@
+/**
+ * @file EPDTransport_BitBang.cpp
+ * @brief Software SPI transport: each bit is clocked manually via GPIO.
+ *
+ * This avoids conflicts with the ESP32 hardware SPI peripheral and lets any
+ * GPIO be used for any signal. The trade-off is a slow bit rate (~1 MHz
+ * effective): a full frame (2 × 58,080 bytes) takes several seconds to
+ * clock out. Use EPDHwSpiTransport when the wiring allows it.
+ *
+ * GPIO writes per byte:
+ *   writeData()      DC + CS + (CS + 8 × (DIN + 2 CLK) + CS) + CS = 30
+ *   burst span byte  8 × 2 CLK + DIN writes only where the bit changes ≤ 24
+ * so streaming planes through beginData() … endData() removes the 6 control
+ * writes per byte, and runs of equal bits (white areas) skip DIN entirely.
+ */
+#include "EPDDisplay.h"
+
+#define GPIO_PIN_SET 1
+#define GPIO_PIN_RESET 0
+
+EPDBitBangTransport::EPDBitBangTransport(int dc_pin, int cs_pin, int clk_pin, int din_pin)
+    : m_DC_pin(dc_pin),
+      m_CS_pin(cs_pin),
+      m_CLK_pin(clk_pin),
+      m_DIN_pin(din_pin),
+      m_DIN_level(0)
+{
+}
+
+bool EPDBitBangTransport::begin()
+{
+    pinMode(m_DC_pin, OUTPUT);
+    pinMode(m_CLK_pin, OUTPUT);
+    pinMode(m_DIN_pin, OUTPUT);
+    pinMode(m_CS_pin, OUTPUT);
+    digitalWrite(m_CS_pin, HIGH);
+    digitalWrite(m_CLK_pin, LOW);
+    return true;
+}
+
+void EPDBitBangTransport::writeCommand(uint8_t command)
+{
+    digitalWrite(m_DC_pin, 0);
+    digitalWrite(m_CS_pin, 0);
+    SPI_WriteByte(command);
+    digitalWrite(m_CS_pin, 1);
+}
+
+void EPDBitBangTransport::writeData(uint8_t data)
+{
+    digitalWrite(m_DC_pin, 1);
+    digitalWrite(m_CS_pin, 0);
+    SPI_WriteByte(data);
+    digitalWrite(m_CS_pin, 1);
+}
+
+void EPDBitBangTransport::beginData()
+{
+    digitalWrite(m_DC_pin, 1);
+    digitalWrite(m_CS_pin, 0);
+    // DIN level is unknown after a command byte: force the first bit to be written
+    m_DIN_level = 0xFF;
+}
+
+void EPDBitBangTransport::writeDataSpan(const uint8_t *data, uint32_t length, bool invert)
+{
+    uint8_t mask = invert ? 0xFF : 0x00;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        shiftByte(data[i] ^ mask);
+    }
+}
+
+void EPDBitBangTransport::writeDataRepeat(uint8_t value, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        shiftByte(value);
+    }
+}
+
+void EPDBitBangTransport::endData()
+{
+    digitalWrite(m_CS_pin, 1);
+}
+
+// Same bit timing as SPI_WriteByte(), but CS is left alone (held low by the
+// burst) and DIN is only written when the bit differs from the previous one.
+void EPDBitBangTransport::shiftByte(uint8_t data)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        uint8_t level = (data & 0x80) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+        if (level != m_DIN_level)
+        {
+            digitalWrite(m_DIN_pin, level);
+            m_DIN_level = level;
+        }
+        data <<= 1;
+
+        digitalWrite(m_CLK_pin, GPIO_PIN_SET);
+        digitalWrite(m_CLK_pin, GPIO_PIN_RESET);
+    }
+}
+
+/**
+ * Bit-banged SPI write: transmits one byte MSB-first using Mode 0
+ * (CPOL=0, CPHA=0 — data sampled on rising clock edge).
+ *
+ * Timing per bit:
+ *   1. Set DIN to the bit value (MSB first)
+ *   2. Pulse CLK HIGH  → controller latches DIN
+ *   3. Pull CLK LOW
+ * CS is asserted (LOW) by the caller (writeCommand / writeData) before this
+ * function is called, but this function also re-asserts CS around the byte
+ * to guard against re-entrant calls.
+ */
+void EPDBitBangTransport::SPI_WriteByte(uint8_t data)
+{
+    digitalWrite(m_CS_pin, GPIO_PIN_RESET);
+
+    for (int i = 0; i < 8; i++)
+    {
+        // Output the MSB of `data` onto DIN
+        if ((data & 0x80) == 0)
+            digitalWrite(m_DIN_pin, GPIO_PIN_RESET);
+        else
+            digitalWrite(m_DIN_pin, GPIO_PIN_SET);
+
+        data <<= 1; // Shift next bit into MSB position
+
+        // Rising edge: controller latches DIN
+        digitalWrite(m_CLK_pin, GPIO_PIN_SET);
+        // Falling edge: prepare for next bit
+        digitalWrite(m_CLK_pin, GPIO_PIN_RESET);
+    }
+    digitalWrite(m_CS_pin, GPIO_PIN_SET);
+}
@@ -0,0 +1,355 @@
+/**
+ * @file EPDTransport_HwSpi.cpp
+ * @brief ESP32 hardware SPI transport (VSPI / HSPI) with DMA block transfers.
+ *
+ * The SPI master driver is used with manual CS: the peripheral's own CS would
+ * be released between transactions, whereas the controller only needs CS low
+ * for the duration of a write, so a whole 58,080-byte plane can be streamed
+ * inside one CS-low window as a chain of DMA transactions.
+ *
+ * Data burst pipeline (beginData() … endData()):
+ *   - Each span is cut into EPD_SPI_CHUNK_SIZE pieces.
+ *   - Two transactions are kept in flight: while DMA drains chunk N, the CPU
+ *     prepares chunk N+1 in the other bounce buffer.
+ *   - A bounce copy is only made when needed (inverted red plane, or source
+ *     memory that DMA cannot read, e.g. PSRAM / flash / unaligned). Otherwise
+ *     the transaction points straight into the framebuffer. The copy runs a
+ *     word at a time (EPDPlaneOps::copy()) whatever the row's alignment.
+ *   - writeDataRepeat() fills a bounce buffer once and queues it repeatedly.
+ *   - endData() waits for the queue to drain before releasing CS.
+ *
+ * Single command/data bytes use polling transactions with the inline tx_data
+ * field, which avoids DMA setup for the many short register writes in hwInit().
+ *
+ * Several transports may share one bus (EPDPanelGroup): each adds its own
+ * device with its own CS, and the bus is freed by the transport that
+ * initialized it, so that one should be destroyed last.
+ */
+#include "EPDDisplay.h"
+
+#if defined(ESP32)
+#include "driver/spi_master.h"
+#include "esp_heap_caps.h"
+#if __has_include("esp_memory_utils.h")
+#include "esp_memory_utils.h"
+#else
+#include "soc/soc_memory_layout.h"
+#endif
+#endif
+
+// Bytes per DMA transaction. Must fit within max_transfer_sz of the bus.
+#define EPD_SPI_CHUNK_SIZE 4096
+
+EPDHwSpiTransport::EPDHwSpiTransport(int dc_pin, int cs_pin, int clk_pin, int din_pin, SPI_BUS bus, uint32_t clock_hz)
+    : m_DC_pin(dc_pin),
+      m_CS_pin(cs_pin),
+      m_CLK_pin(clk_pin),
+      m_DIN_pin(din_pin),
+      m_bus(bus),
+      m_clock_hz(clock_hz),
+      m_device(NULL),
+      m_busReady(false),
+      m_trans(NULL),
+      m_slot(0),
+      m_inFlight(0)
+{
+    m_chunk[0] = NULL;
+    m_chunk[1] = NULL;
+}
+
+#if defined(ESP32)
+
+static spi_host_device_t epdSpiHost(EPDHwSpiTransport::SPI_BUS bus)
+{
+    return (bus == EPDHwSpiTransport::SPI_BUS_HSPI) ? SPI2_HOST : SPI3_HOST;
+}
+
+EPDHwSpiTransport::~EPDHwSpiTransport()
+{
+    if (m_device != NULL)
+    {
+        spi_bus_remove_device((spi_device_handle_t)m_device);
+        m_device = NULL;
+    }
+    if (m_busReady)
+    {
+        spi_bus_free(epdSpiHost(m_bus));
+        m_busReady = false;
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        if (m_chunk[i] != NULL)
+        {
+            heap_caps_free(m_chunk[i]);
+            m_chunk[i] = NULL;
+        }
+    }
+    if (m_trans != NULL)
+    {
+        free(m_trans);
+        m_trans = NULL;
+    }
+}
+
+bool EPDHwSpiTransport::begin()
+{
+    if (m_device != NULL)
+    {
+        return true;
+    }
+
+    pinMode(m_DC_pin, OUTPUT);
+    pinMode(m_CS_pin, OUTPUT);
+    digitalWrite(m_CS_pin, HIGH);
+
+    for (int i = 0; i < 2; i++)
+    {
+        m_chunk[i] = (uint8_t *)heap_caps_malloc(EPD_SPI_CHUNK_SIZE, MALLOC_CAP_DMA);
+        if (m_chunk[i] == NULL)
+        {
+            Debug("Failed to allocate SPI DMA chunk buffer\r\n");
+            return false;
+        }
+    }
+    m_trans = calloc(2, sizeof(spi_transaction_t));
+    if (m_trans == NULL)
+    {
+        Debug("Failed to allocate SPI transactions\r\n");
+        return false;
+    }
+
+    spi_bus_config_t buscfg;
+    memset(&buscfg, 0, sizeof(buscfg));
+    buscfg.mosi_io_num = m_DIN_pin;
+    buscfg.miso_io_num = -1; // The controller is write-only on this board
+    buscfg.sclk_io_num = m_CLK_pin;
+    buscfg.quadwp_io_num = -1;
+    buscfg.quadhd_io_num = -1;
+    buscfg.max_transfer_sz = EPD_SPI_CHUNK_SIZE;
+
+    // A panel group puts several transports on one bus: the first one
+    // initializes it, the others only add their device
+    esp_err_t err = spi_bus_initialize(epdSpiHost(m_bus), &buscfg, SPI_DMA_CH_AUTO);
+    if (err == ESP_OK)
+    {
+        m_busReady = true;
+    }
+    else if (err != ESP_ERR_INVALID_STATE)
+    {
+        Debug("spi_bus_initialize failed\r\n");
+        return false;
+    }
+
+    spi_device_interface_config_t devcfg;
+    memset(&devcfg, 0, sizeof(devcfg));
+    devcfg.clock_speed_hz = (int)m_clock_hz;
+    devcfg.mode = 0;          // CPOL=0, CPHA=0 — same as the bit-banged link
+    devcfg.spics_io_num = -1; // CS is driven manually
+    devcfg.queue_size = 2;    // Double-buffered block transfers
+
+    spi_device_handle_t device;
+    if (spi_bus_add_device(epdSpiHost(m_bus), &devcfg, &device) != ESP_OK)
+    {
+        Debug("spi_bus_add_device failed\r\n");
+        return false;
+    }
+    m_device = device;
+    return true;
+}
+
+void EPDHwSpiTransport::writeByte(uint8_t value, uint8_t dc)
+{
+    spi_transaction_t trans;
+    memset(&trans, 0, sizeof(trans));
+    trans.flags = SPI_TRANS_USE_TXDATA;
+    trans.length = 8;
+    trans.tx_data[0] = value;
+
+    digitalWrite(m_DC_pin, dc);
+    digitalWrite(m_CS_pin, LOW);
+    spi_device_polling_transmit((spi_device_handle_t)m_device, &trans);
+    digitalWrite(m_CS_pin, HIGH);
+}
+
+void EPDHwSpiTransport::writeCommand(uint8_t command)
+{
+    writeByte(command, LOW);
+}
+
+void EPDHwSpiTransport::writeData(uint8_t data)
+{
+    writeByte(data, HIGH);
+}
+
+void EPDHwSpiTransport::beginData()
+{
+    digitalWrite(m_DC_pin, HIGH);
+    digitalWrite(m_CS_pin, LOW);
+}
+
+void EPDHwSpiTransport::queueChunk(const uint8_t *tx, uint32_t length)
+{
+    spi_device_handle_t device = (spi_device_handle_t)m_device;
+    spi_transaction_t *trans = (spi_transaction_t *)m_trans;
+    spi_transaction_t *done;
+
+    // Both slots busy: results come back in queue order, so this frees m_slot
+    if (m_inFlight == 2)
+    {
+        spi_device_get_trans_result(device, &done, portMAX_DELAY);
+        m_inFlight--;
+    }
+
+    memset(&trans[m_slot], 0, sizeof(spi_transaction_t));
+    trans[m_slot].length = length * 8;
+    trans[m_slot].tx_buffer = tx;
+    spi_device_queue_trans(device, &trans[m_slot], portMAX_DELAY);
+    m_inFlight++;
+    m_slot ^= 1;
+}
+
+void EPDHwSpiTransport::drain()
+{
+    spi_transaction_t *done;
+    while (m_inFlight > 0)
+    {
+        spi_device_get_trans_result((spi_device_handle_t)m_device, &done, portMAX_DELAY);
+        m_inFlight--;
+    }
+}
+
+void EPDHwSpiTransport::writeDataSpan(const uint8_t *data, uint32_t length, bool invert)
+{
+    for (uint32_t offset = 0; offset < length;)
+    {
+        uint32_t n = length - offset;
+        if (n > EPD_SPI_CHUNK_SIZE)
+            n = EPD_SPI_CHUNK_SIZE;
+
+        const uint8_t *src = data + offset;
+        if (invert || !esp_ptr_dma_capable(src) || ((uintptr_t)src & 3) != 0)
+        {
+            // The slot about to be filled may still be on the wire
+            if (m_inFlight == 2)
+            {
+                spi_transaction_t *done;
+                spi_device_get_trans_result((spi_device_handle_t)m_device, &done, portMAX_DELAY);
+                m_inFlight--;
+            }
+            uint8_t *dst = m_chunk[m_slot];
+            EPDPlaneOps::copy(dst, src, n, invert);
+            queueChunk(dst, n);
+        }
+        else
+        {
+            queueChunk(src, n);
+        }
+        offset += n;
+    }
+}
+
+void EPDHwSpiTransport::writeDataStrided(const uint8_t *data, uint32_t length, uint8_t stride, bool invert)
+{
+    // Interleaved planes: gather each chunk into a bounce buffer (never zero-copy)
+    uint8_t mask = invert ? 0xFF : 0x00;
+    for (uint32_t offset = 0; offset < length;)
+    {
+        uint32_t n = length - offset;
+        if (n > EPD_SPI_CHUNK_SIZE)
+            n = EPD_SPI_CHUNK_SIZE;
+
+        if (m_inFlight == 2)
+        {
+            spi_transaction_t *done;
+            spi_device_get_trans_result((spi_device_handle_t)m_device, &done, portMAX_DELAY);
+            m_inFlight--;
+        }
+        const uint8_t *src = data + offset * stride;
+        uint8_t *dst = m_chunk[m_slot];
+        for (uint32_t i = 0; i < n; i++)
+            dst[i] = src[i * stride] ^ mask;
+        queueChunk(dst, n);
+        offset += n;
+    }
+}
+
+void EPDHwSpiTransport::writeDataRepeat(uint8_t value, uint32_t count)
+{
+    // Both bounce buffers may be referenced by queued transactions
+    drain();
+    memset(m_chunk[0], value, EPD_SPI_CHUNK_SIZE);
+    while (count > 0)
+    {
+        uint32_t n = (count > EPD_SPI_CHUNK_SIZE) ? EPD_SPI_CHUNK_SIZE : count;
+        // A transaction only reads its buffer, so one filled chunk can back both slots
+        queueChunk(m_chunk[0], n);
+        count -= n;
+    }
+    // Release m_chunk[0] before a following span reuses it as a bounce buffer
+    drain();
+}
+
+void EPDHwSpiTransport::endData()
+{
+    drain();
+    digitalWrite(m_CS_pin, HIGH);
+}
+
+#else // !ESP32
+
+EPDHwSpiTransport::~EPDHwSpiTransport()
+{
+}
+
+bool EPDHwSpiTransport::begin()
+{
+    Debug("Hardware SPI transport is only available on ESP32\r\n");
+    return false;
+}
+
+void EPDHwSpiTransport::writeByte(uint8_t value, uint8_t dc)
+{
+    (void)value;
+    (void)dc;
+}
+
+void EPDHwSpiTransport::writeCommand(uint8_t command)
+{
+    writeByte(command, LOW);
+}
+
+void EPDHwSpiTransport::writeData(uint8_t data)
+{
+    writeByte(data, HIGH);
+}
+
+void EPDHwSpiTransport::beginData()
+{
+}
+
+void EPDHwSpiTransport::writeDataSpan(const uint8_t *data, uint32_t length, bool invert)
+{
+    (void)data;
+    (void)length;
+    (void)invert;
+}
+
+void EPDHwSpiTransport::writeDataStrided(const uint8_t *data, uint32_t length, uint8_t stride, bool invert)
+{
+    (void)data;
+    (void)length;
+    (void)stride;
+    (void)invert;
+}
+
+void EPDHwSpiTransport::writeDataRepeat(uint8_t value, uint32_t count)
+{
+    (void)value;
+    (void)count;
+}
+
+void EPDHwSpiTransport::endData()
+{
+}
+
+#endif // ESP32
@@ -0,0 +1,445 @@
+/**
+ * @file EPDTransport_Mock.cpp
+ * @brief Recording transport: logs every byte instead of driving hardware.
+ *
+ * Intended for host builds (see EPDHostShim.h), where it lets tests check
+ * the exact command stream produced by initialize(), display(), clear() etc.
+ * It also compiles on the device, which is occasionally handy for dumping the
+ * stream a sketch would send.
+ *
+ * The log grows geometrically with realloc(); a full display() records
+ * 2 × 58,080 data bytes plus a handful of commands. Each entry carries the
+ * nowUs() timestamp at which it was sent, so on a host the virtual time spent
+ * in delays and simulated BUSY periods shows up between entries.
+ *
+ * Latency model: byte costs are summed in nanoseconds and charged to the
+ * clock with delayMicroseconds() (virtual on a host). The refresh kind is
+ * told apart the way the controller does it: by the 0x22 sequence of the
+ * activation and by whether a temperature was forced with 0x1A.
+ */
+#include "EPDDisplay.h"
+
+// Estimates, not measurements of a particular board: the BUSY figures are
+// the panel's typical update times at 25 °C, the byte costs follow from
+// ~0.2 µs per digitalWrite(), ~10 ns per GPIO register store and a 10 MHz
+// SPI clock with ~20 µs per polling transaction.
+const EPDMockTransport::LatencyModel EPDMockTransport::LATENCY_BITBANG = {
+    6000,  // commandNs
+    5000,  // dataNs: 8 × (DIN + CLK high + CLK low)
+    1000,  // burstNs
+    16000, // fullMs
+    3500,  // fastMs
+    2000,  // partialMs
+    100,   // loadMs
+    10,    // swResetMs
+    30,    // autoWriteMs
+};
+
+const EPDMockTransport::LatencyModel EPDMockTransport::LATENCY_FAST_GPIO = {
+    400,
+    250,
+    100,
+    16000,
+    3500,
+    2000,
+    100,
+    10,
+    30,
+};
+
+const EPDMockTransport::LatencyModel EPDMockTransport::LATENCY_HWSPI_DMA = {
+    20000,
+    800,
+    20000,
+    16000,
+    3500,
+    2000,
+    100,
+    10,
+    30,
+};
+
+EPDMockTransport::EPDMockTransport()
+    : m_log(NULL),
+      m_count(0),
+      m_capacity(0),
+      m_commands(0),
+      m_data(0),
+      m_bursts(0),
+      m_resets(0),
+      m_busyTimeMs(0),
+      m_busyStart(0),
+      m_busyUs(0),
+      m_busyArmed(false),
+      m_model(NULL),
+      m_pendingNs(0),
+      m_command(0),
+      m_sequence(0),
+      m_forcedTemperature(false),
+      m_began(false),
+      m_inBurst(false),
+      m_bus(NULL),
+      m_busCs(0)
+{
+}
+
+EPDMockTransport::~EPDMockTransport()
+{
+    if (m_log != NULL)
+    {
+        free(m_log);
+        m_log = NULL;
+    }
+}
+
+bool EPDMockTransport::begin()
+{
+    m_began = true;
+    return true;
+}
+
+void EPDMockTransport::writeCommand(uint8_t command)
+{
+    if (m_inBurst)
+    {
+        Debug("EPDMockTransport: command inside a data burst\r\n");
+    }
+    append(command, true);
+    m_commands++;
+    m_command = command;
+
+    if (m_model == NULL)
+    {
+        if (command == 0x20 && m_busyTimeMs > 0)
+        {
+            raiseBusy(m_busyTimeMs);
+        }
+        return;
+    }
+
+    charge(m_model->commandNs);
+    switch (command)
+    {
+    case 0x12:
+        raiseBusy(m_model->swResetMs);
+        break;
+    case 0x18:
+        m_forcedTemperature = false;
+        break;
+    case 0x1A:
+        m_forcedTemperature = true;
+        break;
+    case 0x20:
+        if ((m_sequence & 0x04) == 0)
+        {
+            raiseBusy(m_model->loadMs);
+        }
+        else if (m_sequence & 0x08)
+        {
+            raiseBusy(m_model->partialMs);
+        }
+        else
+        {
+            raiseBusy(m_forcedTemperature ? m_model->fastMs : m_model->fullMs);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void EPDMockTransport::writeData(uint8_t data)
+{
+    append(data, false);
+    m_data++;
+    if (m_command == 0x22)
+    {
+        m_sequence = data;
+    }
+
+    if (m_model != NULL)
+    {
+        charge(m_inBurst ? m_model->dataNs : m_model->dataNs + m_model->burstNs);
+        if (m_command == 0x46 || m_command == 0x47)
+        {
+            raiseBusy(m_model->autoWriteMs);
+        }
+    }
+}
+
+void EPDMockTransport::beginData()
+{
+    if (m_inBurst)
+    {
+        Debug("EPDMockTransport: beginData() inside a burst\r\n");
+    }
+    m_inBurst = true;
+    m_bursts++;
+    if (m_bus != NULL)
+    {
+        m_bus->select(m_busCs);
+    }
+    if (m_model != NULL)
+    {
+        charge(m_model->burstNs);
+    }
+}
+
+void EPDMockTransport::writeDataSpan(const uint8_t *data, uint32_t length, bool invert)
+{
+    for (uint32_t i = 0; i < length; i++)
+    {
+        writeData(invert ? (uint8_t)~data[i] : data[i]);
+    }
+}
+
+void EPDMockTransport::writeDataRepeat(uint8_t value, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        writeData(value);
+    }
+}
+
+void EPDMockTransport::endData()
+{
+    m_inBurst = false;
+    if (m_bus != NULL)
+    {
+        m_bus->release(m_busCs);
+    }
+}
+
+void EPDMockTransport::reset(uint32_t low_ms, uint32_t settle_ms)
+{
+    m_resets++;
+    m_busyArmed = false;
+    EPDTransport::reset(low_ms, settle_ms);
+}
+
+bool EPDMockTransport::isBusy()
+{
+    if (m_busyArmed)
+    {
+        if (nowUs() - m_busyStart < m_busyUs)
+        {
+            return true;
+        }
+        m_busyArmed = false;
+    }
+    return EPDTransport::isBusy();
+}
+
+bool EPDMockTransport::sleepWhileBusy(uint32_t timeout_ms, uint32_t *slept_us)
+{
+    // The CPU sleeps until the BUSY edge: one jump of the clock, not polling
+    uint32_t start = nowUs();
+    if (m_busyArmed)
+    {
+        uint32_t elapsed = start - m_busyStart;
+        if (elapsed < m_busyUs)
+        {
+            uint32_t remaining = m_busyUs - elapsed;
+            if (remaining > timeout_ms * 1000)
+            {
+                remaining = timeout_ms * 1000;
+            }
+            delayMicroseconds(remaining);
+        }
+    }
+    bool released = waitBusy(timeout_ms);
+    *slept_us = nowUs() - start;
+    return released;
+}
+
+void EPDMockTransport::raiseBusy(uint32_t ms)
+{
+    m_busyStart = nowUs();
+    m_busyUs = ms * 1000;
+    m_busyArmed = (ms > 0);
+}
+
+void EPDMockTransport::charge(uint32_t ns)
+{
+    m_pendingNs += ns;
+    if (m_pendingNs >= 1000)
+    {
+        delayMicroseconds(m_pendingNs / 1000);
+        m_pendingNs %= 1000;
+    }
+}
+
+void EPDMockTransport::clearLog()
+{
+    m_count = 0;
+    m_commands = 0;
+    m_data = 0;
+    m_bursts = 0;
+    m_resets = 0;
+}
+
+uint8_t EPDMockTransport::attachBus(EPDMockBus *bus)
+{
+    m_bus = bus;
+    m_busCs = (bus != NULL) ? bus->attach(this) : 0;
+    return m_busCs;
+}
+
+uint32_t EPDMockTransport::dataAfterCommand(uint8_t command) const
+{
+    // Walk backwards to the last occurrence of the command, counting data bytes
+    uint32_t n = 0;
+    for (uint32_t i = m_count; i > 0; i--)
+    {
+        const Entry &e = m_log[i - 1];
+        if (e.isCommand)
+        {
+            if (e.value == command)
+                return n;
+            n = 0;
+        }
+        else
+        {
+            n++;
+        }
+    }
+    return 0;
+}
+
+void EPDMockTransport::append(uint8_t value, bool isCommand)
+{
+    if (m_bus != NULL)
+    {
+        m_bus->transfer(m_busCs, value, isCommand);
+    }
+    if (m_count == m_capacity)
+    {
+        uint32_t capacity = (m_capacity == 0) ? 1024 : m_capacity * 2;
+        Entry *grown = (Entry *)realloc(m_log, capacity * sizeof(Entry));
+        if (grown == NULL)
+        {
+            return; // Out of memory: stop recording, counters keep counting
+        }
+        m_log = grown;
+        m_capacity = capacity;
+    }
+    m_log[m_count].value = value;
+    m_log[m_count].isCommand = isCommand;
+    m_log[m_count].timeUs = nowUs();
+    m_count++;
+}
+
+int32_t EPDMockTransport::findCommand(uint8_t command, uint32_t start) const
+{
+    for (uint32_t i = start; i < m_count; i++)
+    {
+        if (m_log[i].isCommand && m_log[i].value == command)
+            return (int32_t)i;
+    }
+    return -1;
+}
+
+EPDMockBus::EPDMockBus()
+    : m_panelCount(0),
+      m_selected(-1),
+      m_last(-1),
+      m_log(NULL),
+      m_count(0),
+      m_capacity(0),
+      m_conflicts(0),
+      m_overlapped(0),
+      m_switches(0)
+{
+}
+
+EPDMockBus::~EPDMockBus()
+{
+    if (m_log != NULL)
+    {
+        free(m_log);
+        m_log = NULL;
+    }
+}
+
+void EPDMockBus::clearLog()
+{
+    m_count = 0;
+    m_conflicts = 0;
+    m_overlapped = 0;
+    m_switches = 0;
+    m_last = -1;
+}
+
+uint8_t EPDMockBus::attach(EPDMockTransport *panel)
+{
+    for (uint8_t i = 0; i < m_panelCount; i++)
+    {
+        if (m_panels[i] == panel)
+        {
+            return i;
+        }
+    }
+    if (m_panelCount == EPD_MOCK_BUS_PANELS)
+    {
+        Debug("EPDMockBus: too many panels\r\n");
+        return EPD_MOCK_BUS_PANELS - 1;
+    }
+    m_panels[m_panelCount] = panel;
+    return m_panelCount++;
+}
+
+void EPDMockBus::select(uint8_t cs)
+{
+    if (m_selected >= 0 && m_selected != cs)
+    {
+        m_conflicts++;
+    }
+    m_selected = cs;
+}
+
+void EPDMockBus::release(uint8_t cs)
+{
+    if (m_selected == cs)
+    {
+        m_selected = -1;
+    }
+}
+
+void EPDMockBus::transfer(uint8_t cs, uint8_t value, bool isCommand)
+{
+    if (m_selected >= 0 && m_selected != cs)
+    {
+        m_conflicts++;
+    }
+    if (m_last >= 0 && m_last != cs)
+    {
+        m_switches++;
+    }
+    m_last = cs;
+
+    for (uint8_t i = 0; i < m_panelCount; i++)
+    {
+        if (i != cs && m_panels[i]->isBusy())
+        {
+            m_overlapped++;
+            break;
+        }
+    }
+
+    if (m_count == m_capacity)
+    {
+        uint32_t capacity = (m_capacity == 0) ? 1024 : m_capacity * 2;
+        Entry *grown = (Entry *)realloc(m_log, capacity * sizeof(Entry));
+        if (grown == NULL)
+        {
+            return; // Out of memory: stop recording, counters keep counting
+        }
+        m_log = grown;
+        m_capacity = capacity;
+    }
+    m_log[m_count].cs = cs;
+    m_log[m_count].value = value;
+    m_log[m_count].isCommand = isCommand;
+    m_log[m_count].timeUs = m_panels[cs]->nowUs();
+    m_count++;
+}
@@ -0,0 +1,250 @@
+/**
+ * @file test_mock_transport.cpp
+ * @brief Host test of the command stream EPDDisplay sends, recorded by
+ *        EPDMockTransport and EPDMockBus.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++17 -O2 -Isrc test/host/test_mock_transport.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o test_mock_transport
+ *   ./test_mock_transport
+ *
+ * Prints every failed check and exits non-zero if there was one.
+ */
+#include "EPDPanelGroup.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do                                                                      \
+    {                                                                       \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+#define BUSY_PIN 4
+#define RST_PIN 5
+
+static const uint32_t PLANE_BYTES = 110UL * 528;
+
+// No command byte may interrupt the data of the command at index
+static bool dataContiguous(const EPDMockTransport &mock, int32_t index, uint32_t length)
+{
+    if (index < 0 || (uint32_t)index + length >= mock.entryCount())
+    {
+        return false;
+    }
+    for (uint32_t i = index + 1; i <= (uint32_t)index + length; i++)
+    {
+        if (mock.entry(i).isCommand)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void testInitialize()
+{
+    EPDMockTransport mock;
+    EPDDisplay display(BUSY_PIN, RST_PIN, &mock);
+    CHECK(display.initialize());
+    CHECK(mock.resetCount() == 1);
+    CHECK(mock.findCommand(0x12) >= 0); // Software reset
+}
+
+static void testUploads()
+{
+    EPDMockTransport mock;
+    EPDDisplay display(BUSY_PIN, RST_PIN, &mock);
+    display.initialize();
+
+    // First frame: each plane in full, as one burst, then the refresh
+    mock.clearLog();
+    display.fillScreen(EPDDisplay::WHITE);
+    display.drawRectangle(100, 50, 300, 90, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    display.drawRectangle(100, 200, 300, 240, EPDDisplay::RED, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    display.display();
+    int32_t black = mock.findCommand(0x24);
+    int32_t red = mock.findCommand(0x26);
+    CHECK(mock.dataAfterCommand(0x24) == PLANE_BYTES);
+    CHECK(mock.dataAfterCommand(0x26) == PLANE_BYTES);
+    CHECK(dataContiguous(mock, black, PLANE_BYTES));
+    CHECK(dataContiguous(mock, red, PLANE_BYTES));
+    CHECK(mock.burstCount() == 2);
+    CHECK(mock.findCommand(0x20) > red);
+}
+
+static void testUnchanged()
+{
+    EPDMockTransport mock;
+    EPDDisplay display(BUSY_PIN, RST_PIN, &mock);
+    display.initialize();
+    display.fillScreen(EPDDisplay::WHITE);
+    display.drawRectangle(100, 50, 300, 90, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    display.display();
+
+    // Nothing drawn: no plane data, still a refresh
+    mock.clearLog();
+    display.display();
+    CHECK(mock.dataAfterCommand(0x24) == 0);
+    CHECK(mock.dataAfterCommand(0x26) == 0);
+    CHECK(mock.findCommand(0x20) >= 0);
+
+    // One pixel: one byte of one plane
+    mock.clearLog();
+    display.drawPixel(500, 300, EPDDisplay::RED);
+    display.display();
+    CHECK(mock.dataAfterCommand(0x24) == 0);
+    CHECK(mock.dataAfterCommand(0x26) == 1);
+}
+
+static void testAutoWrite()
+{
+    EPDMockTransport mock;
+    EPDDisplay display(BUSY_PIN, RST_PIN, &mock);
+    display.initialize();
+
+    // A uniform plane is filled by the controller (Auto Write RAM): the
+    // all-white red plane goes out as 0x46, only the black one is streamed
+    mock.clearLog();
+    display.fillScreen(EPDDisplay::WHITE);
+    display.drawRectangle(100, 50, 300, 90, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    display.display();
+    CHECK(mock.dataAfterCommand(0x24) == PLANE_BYTES);
+    CHECK(mock.findCommand(0x26) < 0);
+    CHECK(mock.findCommand(0x46) >= 0);
+
+    // The fills wait for BUSY only: on the virtual clock (no BUSY time) a
+    // frame costs the fixed delays of its refresh and nothing more
+    uint32_t start = millis();
+    display.clear();
+    CHECK(mock.findCommand(0x46) >= 0);
+    CHECK(mock.findCommand(0x47) >= 0);
+    CHECK(millis() - start <= 2 * EPD_BUSY_SETTLE_MS);
+
+    display.drawRectangle(100, 50, 300, 90, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    display.display();
+    mock.clearLog();
+    display.fillScreen(EPDDisplay::WHITE);
+    start = millis();
+    display.display();
+    CHECK(mock.findCommand(0x47) >= 0);
+    CHECK(millis() - start <= 2 * EPD_BUSY_SETTLE_MS);
+}
+
+static void drawSparse(EPDDisplay *display, void *arg)
+{
+    display->fillScreen(EPDDisplay::WHITE);
+    display->drawRectangle(400, 250, 420, 270, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+}
+
+static void testBanded()
+{
+    EPDMockTransport mock;
+    EPDDisplay display(BUSY_PIN, RST_PIN, &mock);
+    CHECK(display.initializeBanded(16));
+
+    // 33 bands, one refresh: only the trigger waits out the settle time
+    uint32_t start = millis();
+    display.renderBanded(drawSparse);
+    CHECK(millis() - start <= 2 * EPD_BUSY_SETTLE_MS);
+    CHECK(mock.findCommand(0x20) >= 0);
+
+    // The planes exist with another height already
+    EPDMockTransport other;
+    EPDDisplay full(BUSY_PIN, RST_PIN, &other);
+    CHECK(full.initialize());
+    CHECK(!full.initializeBanded(16));
+}
+
+static void testBusy()
+{
+    EPDMockTransport mock;
+    EPDDisplay display(BUSY_PIN, RST_PIN, &mock);
+    display.initialize();
+    mock.setBusyTime(3000);
+
+    // BUSY after the activation holds display() on the (virtual) clock
+    display.drawRectangle(0, 0, 8, 8, EPDDisplay::RED, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    uint32_t start = millis();
+    display.display();
+    CHECK(millis() - start >= 3000);
+    CHECK(!mock.isBusy());
+}
+
+// Counts the 1 ms polls of a wait loop that go through this transport
+class CountingTransport : public EPDMockTransport
+{
+public:
+    CountingTransport() : polls(0) {}
+
+    void delayMs(uint32_t ms)
+    {
+        polls += (ms == 1);
+        EPDMockTransport::delayMs(ms);
+    }
+
+    uint32_t polls;
+};
+
+static void testSharedBus()
+{
+    EPDMockBus bus;
+    CountingTransport first;
+    EPDMockTransport second;
+    uint8_t firstCs = first.attachBus(&bus);
+    uint8_t secondCs = second.attachBus(&bus);
+    CHECK(firstCs != secondCs);
+    first.setBusyTime(2000);
+    second.setBusyTime(2000);
+
+    // Shared RST on pin 3: one pulse for the group, through the first
+    // panel's transport, which keeps its own (unused) RST pin
+    EPDPanelGroup group(1, 2, -1, 3);
+    group.addPanel(&first);
+    group.addPanel(&second);
+    CHECK(group.initialize());
+    CHECK(first.resetCount() == second.resetCount() + 1);
+    CHECK(first.resetPin() == -1);
+
+    group.panel(0)->fillScreen(EPDDisplay::BLACK);
+    group.panel(1)->fillScreen(EPDDisplay::WHITE);
+    group.panel(1)->drawRectangle(0, 0, 300, 300, EPDDisplay::RED, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    bus.clearLog();
+    group.display();
+
+    // Both panels talked, never inside each other's bursts, and at least
+    // one upload ran while the other panel was refreshing
+    bool seen[2] = {false, false};
+    for (uint32_t i = 0; i < bus.entryCount(); i++)
+    {
+        seen[0] |= bus.entry(i).cs == firstCs;
+        seen[1] |= bus.entry(i).cs == secondCs;
+    }
+    CHECK(seen[0] && seen[1]);
+    CHECK(bus.conflicts() == 0);
+    CHECK(bus.overlappedBytes() > 0);
+
+    // The group's wait for both refreshes runs on the first transport's clock
+    group.panel(0)->drawRectangle(0, 0, 8, 8, EPDDisplay::WHITE, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    CHECK(group.displayAsync());
+    uint32_t polls = first.polls;
+    CHECK(group.waitRefresh());
+    CHECK(first.polls - polls >= 1000);
+}
+
+int main()
+{
+    testInitialize();
+    testUploads();
+    testUnchanged();
+    testAutoWrite();
+    testBanded();
+    testBusy();
+    testSharedBus();
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+/**
+ * @file test_plane_ops.cpp
+ * @brief Host test of the EPDPlaneOps kernels against byte-by-byte
+ *        references, over random lengths and alignments.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++17 -O2 -Isrc test/host/test_plane_ops.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o test_plane_ops
+ *   ./test_plane_ops
+ *
+ * Every buffer is allocated with exactly the bytes the call may touch, so a
+ * build with -fsanitize=address,undefined also catches a kernel reading or
+ * writing past either end (the unaligned copy() path in particular).
+ *
+ * Prints every failed check and exits non-zero if there was one.
+ */
+#include "EPDPlaneOps.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do                                                                      \
+    {                                                                       \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+#define ROUNDS 20000
+#define MAX_LENGTH 300
+
+typedef enum
+{
+    OP_FILL = 0,
+    OP_COPY,
+    OP_COPY_INVERT,
+    OP_INVERT,
+    OP_AND,
+    OP_OR,
+    OP_XOR,
+    OP_COUNT
+} OP;
+
+static uint32_t seed = 1;
+
+static uint32_t random32()
+{
+    seed = seed * 1664525UL + 1013904223UL;
+    return seed >> 8;
+}
+
+// length random bytes behind offset bytes of padding, in a buffer of exactly
+// offset + length bytes (malloc() aligns the start, offset misaligns the data)
+static uint8_t *randomBuffer(uint32_t offset, uint32_t length)
+{
+    uint8_t *buffer = (uint8_t *)malloc(offset + length + (offset + length == 0));
+    for (uint32_t i = 0; i < offset + length; i++)
+    {
+        buffer[i] = (uint8_t)random32();
+    }
+    return buffer;
+}
+
+// One kernel call on dst + dstOffset, compared with the byte loop on a copy
+static void checkKernel(OP op, uint32_t dstOffset, uint32_t srcOffset, uint32_t length)
+{
+    uint8_t *dst = randomBuffer(dstOffset, length);
+    uint8_t *src = randomBuffer(srcOffset, length);
+    uint8_t *expected = (uint8_t *)malloc(dstOffset + length + 1);
+    memcpy(expected, dst, dstOffset + length);
+    uint8_t value = (uint8_t)random32();
+
+    uint8_t *d = dst + dstOffset;
+    const uint8_t *s = src + srcOffset;
+    uint8_t *e = expected + dstOffset;
+    switch (op)
+    {
+    case OP_FILL:
+        EPDPlaneOps::fill(d, value, length);
+        for (uint32_t i = 0; i < length; i++)
+        {
+            e[i] = value;
+        }
+        break;
+    case OP_COPY:
+    case OP_COPY_INVERT:
+        EPDPlaneOps::copy(d, s, length, op == OP_COPY_INVERT);
+        for (uint32_t i = 0; i < length; i++)
+        {
+            e[i] = op == OP_COPY_INVERT ? ~s[i] : s[i];
+        }
+        break;
+    case OP_INVERT:
+        EPDPlaneOps::invert(d, length);
+        for (uint32_t i = 0; i < length; i++)
+        {
+            e[i] = ~e[i];
+        }
+        break;
+    case OP_AND:
+        EPDPlaneOps::mergeAnd(d, s, length);
+        for (uint32_t i = 0; i < length; i++)
+        {
+            e[i] &= s[i];
+        }
+        break;
+    case OP_OR:
+        EPDPlaneOps::mergeOr(d, s, length);
+        for (uint32_t i = 0; i < length; i++)
+        {
+            e[i] |= s[i];
+        }
+        break;
+    default:
+        EPDPlaneOps::mergeXor(d, s, length);
+        for (uint32_t i = 0; i < length; i++)
+        {
+            e[i] ^= s[i];
+        }
+        break;
+    }
+
+    // The padding in front must be untouched as well
+    if (memcmp(dst, expected, dstOffset + length) != 0)
+    {
+        printf("kernel %d failed: dst offset %u, src offset %u, length %u\n",
+               (int)op, (unsigned)dstOffset, (unsigned)srcOffset, (unsigned)length);
+        failures++;
+    }
+    free(dst);
+    free(src);
+    free(expected);
+}
+
+static void testKernels()
+{
+    for (uint32_t round = 0; round < ROUNDS; round++)
+    {
+        checkKernel((OP)(round % OP_COUNT), random32() % 8, random32() % 8, random32() % MAX_LENGTH);
+    }
+}
+
+static void testQueries()
+{
+    for (uint32_t round = 0; round < ROUNDS; round++)
+    {
+        uint32_t offset = random32() % 8;
+        uint32_t length = random32() % MAX_LENGTH;
+        uint8_t *a = randomBuffer(offset, length);
+        uint8_t *b = randomBuffer(offset ^ (round & 3), length);
+        const uint8_t *x = a + offset;
+        uint8_t *y = b + (offset ^ (round & 3));
+
+        uint32_t bits = 0;
+        for (uint32_t i = 0; i < length; i++)
+        {
+            for (uint8_t bit = 0x01; bit != 0; bit <<= 1)
+            {
+                bits += (x[i] & bit) != 0;
+            }
+        }
+        CHECK(EPDPlaneOps::countSetBits(x, length) == bits);
+
+        // Equal but for at most one byte
+        memcpy(y, x, length);
+        int32_t at = -1;
+        if (length > 0 && (round & 4))
+        {
+            at = random32() % length;
+            y[at] ^= 1 << (random32() % 8);
+        }
+        CHECK(EPDPlaneOps::findDifference(x, y, length) == at);
+
+        // Uniform but for at most one byte
+        uint8_t value = (uint8_t)random32();
+        memset(y, value, length);
+        bool uniform = true;
+        if (length > 0 && (round & 8))
+        {
+            y[random32() % length] ^= 0x80;
+            uniform = false;
+        }
+        CHECK(EPDPlaneOps::isUniform(y, value, length) == uniform);
+
+        free(a);
+        free(b);
+    }
+}
+
+int main()
+{
+    testKernels();
+    testQueries();
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
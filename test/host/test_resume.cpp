@@ -0,0 +1,112 @@
+/**
+ * @file test_resume.cpp
+ * @brief Host test of the resume from MCU deep sleep: the frame fingerprint
+ *        saved by sleep() and the uploads it saves after the next start.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++17 -O2 -Isrc test/host/test_resume.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o test_resume
+ *   ./test_resume
+ *
+ * On the host EPDRtcFrameStore keeps its record in a static buffer, so a new
+ * display object stands in for the MCU waking from deep sleep.
+ *
+ * Prints every failed check and exits non-zero if there was one.
+ */
+#include "EPDDisplay.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do                                                                      \
+    {                                                                       \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static const uint32_t PLANE_BYTES = 110UL * 528;
+
+static void drawScene(EPDDisplay &display)
+{
+    display.fillScreen(EPDDisplay::WHITE);
+    display.drawRectangle(40, 40, 440, 140, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    display.drawString(40, 300, "12:34", &EPDDisplay::Font24, EPDDisplay::RED, EPDDisplay::WHITE);
+}
+
+// One MCU session: start, show the scene (plus a change), deep sleep.
+// Returns whether the start wiped controller RAM (Auto Write RAM).
+static bool session(EPDRtcFrameStore &store, bool change, EPDMockTransport &mock,
+                    EPDDisplay::UploadStats *stats)
+{
+    EPDDisplay display(&mock);
+    display.setFrameStore(&store);
+    CHECK(display.initialize());
+    display.resetUploadStats();
+    bool wiped = mock.findCommand(0x46) >= 0;
+
+    drawScene(display);
+    if (change)
+    {
+        display.drawRectangle(600, 400, 620, 420, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    }
+    mock.clearLog();
+    display.display();
+    display.getUploadStats(stats);
+    display.sleep();
+    return wiped;
+}
+
+static void testResume()
+{
+    EPDRtcFrameStore store;
+    store.erase();
+    EPDDisplay::UploadStats stats;
+
+    // Cold start: no record, controller RAM is wiped and the frame sent
+    {
+        EPDMockTransport mock;
+        CHECK(session(store, false, mock, &stats));
+        CHECK(mock.findCommand(0x20) >= 0);
+        CHECK(stats.refreshesSkipped == 0);
+    }
+
+    // Same frame after waking: RAM kept, nothing sent, no refresh
+    {
+        EPDMockTransport mock;
+        CHECK(!session(store, false, mock, &stats));
+        CHECK(mock.dataAfterCommand(0x24) == 0);
+        CHECK(mock.dataAfterCommand(0x26) == 0);
+        CHECK(mock.findCommand(0x20) < 0);
+        CHECK(stats.refreshesSkipped == 1);
+    }
+
+    // One small change: only its band is sent, then the refresh
+    {
+        EPDMockTransport mock;
+        CHECK(!session(store, true, mock, &stats));
+        CHECK(mock.dataAfterCommand(0x24) > 0);
+        CHECK(mock.dataAfterCommand(0x24) < PLANE_BYTES / 4);
+        CHECK(mock.findCommand(0x20) >= 0);
+        CHECK(stats.refreshesSkipped == 0);
+    }
+
+    // The record is gone: back to a cold start
+    store.erase();
+    {
+        EPDMockTransport mock;
+        EPDDisplay display(&mock);
+        display.setFrameStore(&store);
+        CHECK(display.initialize());
+        CHECK(mock.findCommand(0x46) >= 0);
+    }
+}
+
+int main()
+{
+    testResume();
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file test_scheduler.cpp
+ * @brief Host test of EPDRefreshScheduler on the virtual clock: coalescing,
+ *        minimum interval, urgent requests and forced full refreshes.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++17 -O2 -Isrc test/host/test_scheduler.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o test_scheduler
+ *   ./test_scheduler
+ *
+ * Prints every failed check and exits non-zero if there was one.
+ */
+#include "EPDRefreshScheduler.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do                                                                      \
+    {                                                                       \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+#define BUSY_MS 3000
+
+// Let the virtual clock run, polling like loop() would
+static void run(EPDRefreshScheduler &scheduler, uint32_t ms)
+{
+    for (uint32_t waited = 0; waited < ms; waited += 100)
+    {
+        delay(100);
+        scheduler.poll();
+    }
+}
+
+static void testCoalescing()
+{
+    EPDMockTransport mock;
+    mock.setBusyTime(BUSY_MS);
+    EPDDisplay display(&mock);
+    display.initialize();
+    EPDRefreshScheduler scheduler(&display);
+
+    // A burst of requests within the hold time makes one refresh
+    for (int i = 0; i < 3; i++)
+    {
+        display.drawRectangle(100 * i, 100, 100 * i + 50, 150, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+        scheduler.request();
+        delay(500);
+    }
+    CHECK(!scheduler.poll());
+    CHECK(scheduler.isPending());
+    run(scheduler, EPD_SCHED_NORMAL_HOLD_MS);
+    CHECK(!scheduler.isPending());
+
+    EPDRefreshScheduler::Stats stats;
+    scheduler.getStats(&stats);
+    CHECK(stats.requests == 3);
+    CHECK(stats.coalesced == 2);
+    CHECK(stats.refreshes == 1);
+}
+
+static void testMinInterval()
+{
+    EPDMockTransport mock;
+    mock.setBusyTime(BUSY_MS);
+    EPDDisplay display(&mock);
+    display.initialize();
+    EPDRefreshScheduler scheduler(&display);
+    scheduler.setMinInterval(60000);
+    scheduler.setHoldTime(EPDRefreshScheduler::PRIORITY_NORMAL, 0);
+
+    scheduler.request();
+    CHECK(scheduler.poll());
+    uint32_t start = millis();
+
+    // Held back until a minute after the previous start
+    display.drawRectangle(100, 100, 150, 150, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    scheduler.request();
+    run(scheduler, 30000);
+    CHECK(scheduler.isPending());
+    CHECK(scheduler.timeUntilRefresh() <= 30000);
+    CHECK(scheduler.timeUntilRefresh() > 29000);
+    while (scheduler.isPending())
+    {
+        run(scheduler, 100);
+    }
+    CHECK(millis() - start >= 60000);
+    CHECK(millis() - start < 60500);
+
+    // Urgent: starts as soon as the panel is idle, whatever the interval
+    display.drawRectangle(200, 100, 250, 150, EPDDisplay::RED, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    run(scheduler, BUSY_MS + 100);
+    scheduler.request(EPDRefreshScheduler::PRIORITY_URGENT);
+    CHECK(!scheduler.isPending());
+
+    EPDRefreshScheduler::Stats stats;
+    scheduler.getStats(&stats);
+    CHECK(stats.refreshes == 3);
+    CHECK(stats.urgent == 1);
+}
+
+static void testForcedFull()
+{
+    EPDMockTransport mock;
+    mock.setBusyTime(BUSY_MS);
+    EPDDisplay display(&mock);
+    display.initialize();
+    display.fillScreen(EPDDisplay::WHITE);
+    display.display();
+
+    EPDRefreshScheduler scheduler(&display);
+    scheduler.setMinInterval(0);
+    scheduler.setHoldTime(EPDRefreshScheduler::PRIORITY_NORMAL, 0);
+    scheduler.setFullRefreshEvery(2);
+    display.setRefreshMode(EPDDisplay::REFRESH_FAST_BW);
+
+    // Black-only changes: two fast refreshes, then a forced full one
+    EPDDisplay::REFRESH_MODE modes[3];
+    for (int i = 0; i < 3; i++)
+    {
+        display.drawRectangle(100 * i, 100, 100 * i + 50, 150, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+        scheduler.request();
+        CHECK(scheduler.poll());
+        modes[i] = display.getLastRefreshMode();
+        run(scheduler, BUSY_MS + 100);
+    }
+    CHECK(modes[0] == EPDDisplay::REFRESH_FAST_BW);
+    CHECK(modes[1] == EPDDisplay::REFRESH_FAST_BW);
+    CHECK(modes[2] == EPDDisplay::REFRESH_FULL_TRICOLOR);
+    CHECK(display.getRefreshMode() == EPDDisplay::REFRESH_FAST_BW);
+
+    EPDRefreshScheduler::Stats stats;
+    scheduler.getStats(&stats);
+    CHECK(stats.forcedFull == 1);
+}
+
+int main()
+{
+    testCoalescing();
+    testMinInterval();
+    testForcedFull();
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file test_shapes.cpp
+ * @brief Host test of the shape primitives against a drawPixel() reference,
+ *        compared on EPDPanelEmulator images.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++17 -O2 -Isrc test/host/test_shapes.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o test_shapes
+ *   ./test_shapes
+ *
+ * Prints every failed check and exits non-zero if there was one.
+ */
+#include "EPDPanelEmulator.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do                                                                      \
+    {                                                                       \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+// One midpoint step: four pixels, or for a fill the row spans widened by grow
+static void plotStep(EPDDisplay &display, int32_t xc, int32_t yc, int32_t x, int32_t y,
+                     EPDDisplay::COLOR color, bool filled, int32_t grow)
+{
+    if (!filled)
+    {
+        display.drawPixel(xc + x, yc + y, color);
+        display.drawPixel(xc - x, yc + y, color);
+        display.drawPixel(xc + x, yc - y, color);
+        display.drawPixel(xc - x, yc - y, color);
+        return;
+    }
+    for (int32_t dy = -grow; dy <= grow; dy++)
+    {
+        for (int32_t px = xc - x - grow; px <= xc + x + grow; px++)
+        {
+            display.drawPixel(px, yc - y + dy, color);
+            display.drawPixel(px, yc + y + dy, color);
+        }
+    }
+}
+
+// The midpoint ellipse drawEllipse() is built on, plotted with drawPixel()
+static void referenceEllipse(EPDDisplay &display, int32_t xc, int32_t yc, int32_t rx, int32_t ry,
+                             EPDDisplay::COLOR color, bool filled, int32_t grow)
+{
+    int32_t x = 0;
+    int32_t y = ry;
+    int32_t rx2 = rx * rx;
+    int32_t ry2 = ry * ry;
+    int32_t s = 2 * ry2 + rx2 * (1 - 2 * ry);
+
+    while (ry2 * x <= rx2 * y)
+    {
+        plotStep(display, xc, yc, x, y, color, filled, grow);
+        if (s >= 0)
+        {
+            s += 4 * rx2 * (1 - y);
+            y--;
+        }
+        s += ry2 * ((4 * x) + 6);
+        x++;
+    }
+
+    s = 2 * rx2 + ry2 * (1 - 2 * rx);
+    while (y >= 0)
+    {
+        plotStep(display, xc, yc, x, y, color, filled, grow);
+        if (s <= 0)
+        {
+            s += 4 * ry2 * (1 + x);
+            x++;
+        }
+        s += rx2 * (-4 * y + 6);
+        y--;
+    }
+}
+
+// Pixels that differ between drawEllipse() and the reference
+static uint32_t ellipseDiff(uint16_t xc, uint16_t yc, uint16_t rx, uint16_t ry,
+                            uint8_t line_width, EPDDisplay::DRAW_FILL draw_fill)
+{
+    EPDPanelEmulator actualPanel;
+    EPDPanelEmulator expectedPanel;
+    EPDDisplay actual(&actualPanel);
+    EPDDisplay expected(&expectedPanel);
+    actual.initialize();
+    expected.initialize();
+
+    actual.fillScreen(EPDDisplay::WHITE);
+    actual.drawEllipse(xc, yc, rx, ry, EPDDisplay::BLACK, line_width, draw_fill);
+    actual.display();
+    expected.fillScreen(EPDDisplay::WHITE);
+    referenceEllipse(expected, xc, yc, rx, ry, EPDDisplay::BLACK, draw_fill == EPDDisplay::DRAW_FULL, line_width - 1);
+    expected.display();
+    return actualPanel.diffPixels(expectedPanel);
+}
+
+static void testEllipseOutline()
+{
+    const EPDDisplay::DRAW_FILL EMPTY = EPDDisplay::DRAW_EMPTY;
+    CHECK(ellipseDiff(440, 264, 200, 120, 1, EMPTY) == 0);
+    CHECK(ellipseDiff(440, 264, 120, 200, 1, EMPTY) == 0);
+    // Narrow and tall: the midpoint steps past radius_x
+    CHECK(ellipseDiff(363, 216, 3, 100, 1, EMPTY) == 0);
+    CHECK(ellipseDiff(363, 216, 10, 80, 1, EMPTY) == 0);
+    // Clipped by the display edges
+    CHECK(ellipseDiff(2, 200, 4, 120, 1, EMPTY) == 0);
+    CHECK(ellipseDiff(877, 520, 6, 90, 1, EMPTY) == 0);
+}
+
+static void testEllipseFilled()
+{
+    const EPDDisplay::DRAW_FILL FULL = EPDDisplay::DRAW_FULL;
+    CHECK(ellipseDiff(440, 264, 200, 120, 1, FULL) == 0);
+    CHECK(ellipseDiff(440, 264, 120, 200, 3, FULL) == 0);
+    // Narrow and tall, with and without a line width
+    CHECK(ellipseDiff(363, 216, 3, 100, 1, FULL) == 0);
+    CHECK(ellipseDiff(363, 216, 10, 80, 1, FULL) == 0);
+    CHECK(ellipseDiff(363, 216, 10, 80, 2, FULL) == 0);
+    // Clipped by the display edges
+    CHECK(ellipseDiff(2, 200, 4, 120, 2, FULL) == 0);
+    CHECK(ellipseDiff(877, 520, 6, 90, 1, FULL) == 0);
+}
+
+int main()
+{
+    testEllipseOutline();
+    testEllipseFilled();
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
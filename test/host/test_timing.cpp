@@ -0,0 +1,109 @@
+/**
+ * @file test_timing.cpp
+ * @brief Host test of the frame and startup time breakdowns, against the
+ *        EPDMockTransport latency model on the virtual clock.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++17 -O2 -Isrc test/host/test_timing.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o test_timing
+ *   ./test_timing
+ *
+ * Prints every failed check and exits non-zero if there was one.
+ */
+#include "EPDDisplay.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do                                                                      \
+    {                                                                       \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static const EPDMockTransport::LatencyModel &MODEL = EPDMockTransport::LATENCY_HWSPI_DMA;
+
+static void testFrameTiming()
+{
+    EPDMockTransport mock;
+    mock.setLatencyModel(&MODEL);
+    EPDDisplay display(&mock);
+    CHECK(display.initialize());
+
+    display.fillScreen(EPDDisplay::WHITE);
+    display.drawRectangle(0, 0, 880, 264, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    display.drawRectangle(0, 264, 880, 528, EPDDisplay::RED, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    uint32_t start = micros();
+    display.display();
+    uint32_t elapsed = micros() - start;
+
+    EPDDisplay::FrameTiming timing;
+    display.getFrameTiming(&timing);
+    // Two streamed planes of 58080 bytes at dataNs each
+    CHECK(timing.uploadUs >= 2 * 58080UL * MODEL.dataNs / 1000);
+    // The full tricolor refresh holds BUSY for fullMs
+    CHECK(timing.busyUs >= MODEL.fullMs * 1000);
+    CHECK(timing.busyUs < (MODEL.fullMs + 100) * 1000);
+    CHECK(timing.totalUs == timing.uploadUs + timing.busyUs + timing.settleUs);
+    CHECK(timing.totalUs <= elapsed);
+    CHECK(timing.totalUs + 1000 > elapsed);
+}
+
+static void testStartupTiming()
+{
+    EPDMockTransport mock;
+    mock.setLatencyModel(&MODEL);
+    EPDDisplay display(&mock);
+    CHECK(display.initialize());
+
+    EPDDisplay::StartupTiming timing;
+    display.getStartupTiming(&timing);
+    CHECK(timing.totalUs == timing.resetUs + timing.uploadUs + timing.busyUs + timing.settleUs);
+    // Software reset and the two auto writes wait on their BUSY edges...
+    CHECK(timing.busyUs >= (MODEL.swResetMs + 2 * MODEL.autoWriteMs) * 1000);
+    // ...and only add the guard time of a few BUSY releases
+    CHECK(timing.settleUs < 10 * EPD_INIT_GUARD_MS * 1000);
+
+    display.setInitGuardTime(20);
+    display.sleep();
+    display.wakeUp();
+    EPDDisplay::StartupTiming guarded;
+    display.getStartupTiming(&guarded);
+    CHECK(guarded.settleUs >= 3 * 20 * 1000UL);
+}
+
+static void testLightSleep()
+{
+    EPDMockTransport mock;
+    mock.setLatencyModel(&MODEL);
+    EPDDisplay display(&mock);
+    display.initialize();
+
+    // Polling: nothing slept
+    display.fillScreen(EPDDisplay::WHITE);
+    display.drawRectangle(100, 100, 150, 150, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    display.display();
+    EPDDisplay::FrameTiming timing;
+    display.getFrameTiming(&timing);
+    CHECK(timing.sleptUs == 0);
+
+    // Light sleep: the refresh wait is slept, and it is part of busyUs
+    display.setLightSleep(true);
+    display.drawRectangle(200, 100, 250, 150, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    display.display();
+    display.getFrameTiming(&timing);
+    CHECK(timing.sleptUs >= MODEL.fullMs * 1000);
+    CHECK(timing.sleptUs <= timing.busyUs);
+}
+
+int main()
+{
+    testFrameTiming();
+    testStartupTiming();
+    testLightSleep();
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
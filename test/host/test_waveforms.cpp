@@ -0,0 +1,150 @@
+/**
+ * @file test_waveforms.cpp
+ * @brief Host test of the refresh modes: the waveform load and update
+ *        sequences EPDDisplay sends, recorded by EPDMockTransport.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++17 -O2 -Isrc test/host/test_waveforms.cpp \
+ *       $(find src -name '*.cpp' ! -name main.cpp) -o test_waveforms
+ *   ./test_waveforms
+ *
+ * Prints every failed check and exits non-zero if there was one.
+ */
+#include "EPDDisplay.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do                                                                      \
+    {                                                                       \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+#define BUSY_PIN 4
+#define RST_PIN 5
+
+// First data byte of the command at index, -1 if there is none
+static int32_t firstData(const EPDMockTransport &mock, int32_t index)
+{
+    if (index < 0 || (uint32_t)index + 1 >= mock.entryCount() || mock.entry(index + 1).isCommand)
+    {
+        return -1;
+    }
+    return mock.entry(index + 1).value;
+}
+
+// A waveform load: temperature to 0x1A, LUT load sequence, activation
+static void checkLoad(const EPDMockTransport &mock, int32_t temperature)
+{
+    int32_t at = mock.findCommand(0x1A);
+    CHECK(firstData(mock, at) == temperature);
+    int32_t load = mock.findCommand(0x22, at);
+    CHECK(firstData(mock, load) == 0x91);
+    CHECK(mock.findCommand(0x20, load) > load);
+}
+
+// The refresh: the last 0x22 of the frame, followed by the activation
+static void checkUpdate(const EPDMockTransport &mock, int32_t sequence)
+{
+    int32_t update = -1;
+    for (int32_t at = mock.findCommand(0x22); at >= 0; at = mock.findCommand(0x22, at + 1))
+    {
+        update = at;
+    }
+    CHECK(firstData(mock, update) == sequence);
+    CHECK(mock.findCommand(0x20, update) > update);
+}
+
+static void testFastModes()
+{
+    EPDMockTransport mock;
+    EPDDisplay display(BUSY_PIN, RST_PIN, &mock);
+    CHECK(display.initialize());
+    display.fillScreen(EPDDisplay::WHITE);
+    display.display();
+
+    // Black change only: OTP waveform for 90 °C, then the fast refresh
+    display.setRefreshMode(EPDDisplay::REFRESH_FAST_BW);
+    display.drawRectangle(100, 100, 150, 150, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    mock.clearLog();
+    display.display();
+    checkLoad(mock, 90);
+    checkUpdate(mock, 0xC7);
+    CHECK(display.getLastRefreshMode() == EPDDisplay::REFRESH_FAST_BW);
+
+    // Same waveform again: nothing to reload
+    display.drawRectangle(200, 100, 250, 150, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    mock.clearLog();
+    display.display();
+    CHECK(mock.findCommand(0x1A) < 0);
+    checkUpdate(mock, 0xC7);
+
+    // Differential refresh with the 110 °C waveform
+    display.setRefreshMode(EPDDisplay::REFRESH_PARTIAL_BW);
+    display.drawRectangle(300, 100, 350, 150, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    mock.clearLog();
+    display.display();
+    checkLoad(mock, 110);
+    checkUpdate(mock, 0xCF);
+    CHECK(display.getLastRefreshMode() == EPDDisplay::REFRESH_PARTIAL_BW);
+}
+
+static void testRedFallsBackToFull()
+{
+    EPDMockTransport mock;
+    EPDDisplay display(BUSY_PIN, RST_PIN, &mock);
+    display.initialize();
+    display.fillScreen(EPDDisplay::WHITE);
+    display.display();
+
+    display.setRefreshMode(EPDDisplay::REFRESH_FAST_BW);
+    display.drawRectangle(100, 100, 150, 150, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    display.display();
+
+    // A fast mode cannot drive red: the full waveform is loaded back
+    display.drawRectangle(200, 100, 250, 150, EPDDisplay::RED, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    mock.clearLog();
+    display.display();
+    CHECK(display.getLastRefreshMode() == EPDDisplay::REFRESH_FULL_TRICOLOR);
+    CHECK(mock.findCommand(0x1A) < 0);
+    CHECK(firstData(mock, mock.findCommand(0x18)) == 0x80);
+    checkUpdate(mock, 0xC7);
+}
+
+static void testCustomLut()
+{
+    static const uint8_t LUT[4] = {0x12, 0x34, 0x56, 0x78};
+    static const EPDDisplay::Waveform OTP_OVER_LUT = {LUT, sizeof(LUT), true, 90, 0x91, 0xC7};
+    static const EPDDisplay::Waveform CUSTOM = {LUT, sizeof(LUT), true, 90, 0x81, 0xC7};
+
+    EPDMockTransport mock;
+    EPDDisplay display(BUSY_PIN, RST_PIN, &mock);
+    display.initialize();
+    display.fillScreen(EPDDisplay::WHITE);
+    display.display();
+
+    // A load sequence with 0x10 would replace the LUT by the OTP one
+    CHECK(!display.setWaveform(EPDDisplay::REFRESH_FAST_BW, &OTP_OVER_LUT));
+    CHECK(display.setWaveform(EPDDisplay::REFRESH_FAST_BW, &CUSTOM));
+
+    display.setRefreshMode(EPDDisplay::REFRESH_FAST_BW);
+    display.drawRectangle(100, 100, 150, 150, EPDDisplay::BLACK, 1, EPDDisplay::LINE_SOLID, EPDDisplay::DRAW_FULL);
+    mock.clearLog();
+    display.display();
+    CHECK(mock.dataAfterCommand(0x32) == sizeof(LUT));
+    CHECK(firstData(mock, mock.findCommand(0x32)) == LUT[0]);
+    CHECK(firstData(mock, mock.findCommand(0x22)) == 0x81);
+}
+
+int main()
+{
+    testFastModes();
+    testRedFallsBackToFull();
+    testCustomLut();
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}